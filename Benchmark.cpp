@@ -0,0 +1,1159 @@
+/**
+ * Micro benchmarks for the Fraction class.
+ * Build and run with: make bench && ./bench, or make bench-json to write bench.json
+ *
+ * Options:
+ *   --list           print the benchmark groups and exit
+ *   --filter TEXT    run only the groups whose name contains TEXT
+ *   --json FILE      also write every result to FILE as JSON
+ *   --label TEXT     label stored in the JSON report, for example the commit
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "sources/AtomicFraction.hpp"
+#include "sources/BigFraction.hpp"
+#include "sources/CompactFraction.hpp"
+#include "sources/FractionCodec.hpp"
+#include "sources/FractionExpr.hpp"
+#include "sources/FractionFile.hpp"
+#include "sources/Fraction.hpp"
+#include "sources/FractionHashMap.hpp"
+#include "sources/FractionReduce.hpp"
+#include "sources/FractionSort.hpp"
+#include "sources/FractionVector.hpp"
+#include "sources/Gcd.hpp"
+#include "sources/LazyFraction.hpp"
+#include "sources/ShardedFractionAccumulator.hpp"
+
+using namespace std;
+using namespace ariel;
+
+namespace {
+
+    const size_t INPUT_SIZE = 1 << 12;
+
+    // Rounds over the input before timing starts, so that caches and branch predictors are warm
+    const int WARMUP_ROUNDS = 10;
+
+    // Timed samples per benchmark, and rounds over the input per sample
+    const int REPETITIONS = 20;
+    const int ROUNDS_PER_REPETITION = 10;
+
+    // Keeps the optimizer from discarding the benchmarked computation
+    template<typename T>
+    void doNotOptimize(const T &value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // The samples of one benchmark, each in the given unit
+    struct Result {
+        string name;
+        string unit;
+        vector<double> samples; // Sorted
+    };
+
+    // Every result of the run, in order
+    vector<Result> results;
+
+    // The value below which the given fraction of the sorted samples lie, interpolating between neighbours
+    double percentile(const vector<double> &sorted, double fraction) {
+        double position = fraction * static_cast<double>(sorted.size() - 1);
+        auto below = static_cast<size_t>(position);
+        size_t above = min(below + 1, sorted.size() - 1);
+        return sorted[below] + (sorted[above] - sorted[below]) * (position - static_cast<double>(below));
+    }
+
+    // Prints the median and spread of the samples and keeps them for the JSON report
+    void record(const string &name, const string &unit, vector<double> samples) {
+        std::sort(samples.begin(), samples.end());
+        cout << name << ": " << percentile(samples, 0.5) << " " << unit;
+        if (samples.size() > 1) {
+            cout << " (p10 " << percentile(samples, 0.1) << ", p90 " << percentile(samples, 0.9) << ")";
+        }
+        cout << endl;
+        results.push_back({name, unit, std::move(samples)});
+    }
+
+    // Runs body(i) for every input index, WARMUP_ROUNDS times untimed and then REPETITIONS times
+    // ROUNDS_PER_REPETITION times, and records the cost of a single call in nanoseconds
+    template<typename Body>
+    void measure(const string &name, size_t size, Body body) {
+        for (int round = 0; round < WARMUP_ROUNDS; round++) {
+            for (size_t i = 0; i < size; i++) {
+                body(i);
+            }
+        }
+        vector<double> samples;
+        for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+            auto start = chrono::steady_clock::now();
+            for (int round = 0; round < ROUNDS_PER_REPETITION; round++) {
+                for (size_t i = 0; i < size; i++) {
+                    body(i);
+                }
+            }
+            auto elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            samples.push_back(elapsed / (static_cast<double>(size) * ROUNDS_PER_REPETITION));
+        }
+        record(name, "ns/op", std::move(samples));
+    }
+
+    // Random non zero fractions with numerators and denominators below the given bound
+    vector<Fraction> randomFractions(size_t count, int bound, unsigned seed) {
+        mt19937 engine(seed);
+        uniform_int_distribution<int> numerators(-bound, bound);
+        uniform_int_distribution<int> denominators(1, bound);
+        vector<Fraction> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            // Zero is skipped so that every input is a valid divisor
+            int numerator = numerators(engine);
+            result.emplace_back(numerator == 0 ? 1 : numerator, denominators(engine));
+        }
+        return result;
+    }
+
+    // The lcm based addition Fraction::operator+ used before the 64-bit rewrite, kept as a baseline
+    Fraction legacyAdd(const Fraction &lhs, const Fraction &rhs) {
+        int common_denominator = std::lcm(lhs.getDenominator(), rhs.getDenominator());
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        if (common_denominator != 0 &&
+            ((std::abs(lhs.getNumerator()) > max_int / std::abs(common_denominator / lhs.getDenominator())) ||
+             (std::abs(rhs.getNumerator()) > max_int / std::abs(common_denominator / rhs.getDenominator())))) {
+            throw std::overflow_error("Fraction overflow");
+        }
+        int term1 = lhs.getNumerator() * (common_denominator / lhs.getDenominator());
+        int term2 = rhs.getNumerator() * (common_denominator / rhs.getDenominator());
+        if ((term1 > 0 && term2 > max_int - term1) || (term1 < 0 && term2 < min_int - term1)) {
+            throw std::overflow_error("Fraction overflow");
+        }
+        return Fraction(term1 + term2, common_denominator);
+    }
+
+    void benchAddition() {
+        vector<Fraction> lhs = randomFractions(INPUT_SIZE, 1 << 12, 1);
+        vector<Fraction> rhs = randomFractions(INPUT_SIZE, 1 << 12, 2);
+        measure("add (lcm baseline)", INPUT_SIZE, [&](size_t i) { doNotOptimize(legacyAdd(lhs[i], rhs[i])); });
+        measure("add (64-bit)", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] + rhs[i]); });
+        measure("sub (64-bit)", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] - rhs[i]); });
+        measure("mul (cross-reduced)", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] * rhs[i]); });
+        measure("div (cross-reduced)", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] / rhs[i]); });
+    }
+
+    // Every operator and conversion declared in Fraction.hpp, on the same operands
+    void benchOperators() {
+        vector<Fraction> lhs = randomFractions(INPUT_SIZE, 1 << 12, 1);
+        vector<Fraction> rhs = randomFractions(INPUT_SIZE, 1 << 12, 2);
+        mt19937 engine(20);
+        uniform_int_distribution<int> terms(-(1 << 20), 1 << 20);
+        uniform_int_distribution<int> thousandths(-100000, 100000);
+        vector<int> numerators;
+        vector<int> denominators;
+        vector<float> floats;
+        vector<string> texts;
+        for (size_t i = 0; i < INPUT_SIZE; i++) {
+            numerators.push_back(terms(engine));
+            denominators.push_back(terms(engine) | 1);
+            floats.push_back(static_cast<float>(thousandths(engine)) / 1000);
+            ostringstream stream;
+            stream << lhs[i];
+            texts.push_back(stream.str());
+        }
+        measure("Fraction(n, d)", INPUT_SIZE, [&](size_t i) {
+            doNotOptimize(Fraction(numerators[i], denominators[i]));
+        });
+        measure("Fraction(float)", INPUT_SIZE, [&](size_t i) { doNotOptimize(Fraction(floats[i])); });
+        measure("simplify", INPUT_SIZE, [&](size_t i) {
+            Fraction value = lhs[i];
+            value.simplify();
+            doNotOptimize(value);
+        });
+        measure("operator+", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] + rhs[i]); });
+        measure("operator-", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] - rhs[i]); });
+        measure("operator*", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] * rhs[i]); });
+        measure("operator/", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] / rhs[i]); });
+        measure("operator<=>", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] <=> rhs[i]); });
+        measure("operator<", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] < rhs[i]); });
+        measure("operator>", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] > rhs[i]); });
+        measure("operator<=", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] <= rhs[i]); });
+        measure("operator>=", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] >= rhs[i]); });
+        measure("operator==", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] == rhs[i]); });
+        measure("operator!=", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] != rhs[i]); });
+        measure("prefix operator++", INPUT_SIZE, [&](size_t i) {
+            Fraction value = lhs[i];
+            doNotOptimize(++value);
+        });
+        measure("postfix operator++", INPUT_SIZE, [&](size_t i) {
+            Fraction value = lhs[i];
+            doNotOptimize(value++);
+            doNotOptimize(value);
+        });
+        measure("prefix operator--", INPUT_SIZE, [&](size_t i) {
+            Fraction value = lhs[i];
+            doNotOptimize(--value);
+        });
+        measure("postfix operator--", INPUT_SIZE, [&](size_t i) {
+            Fraction value = lhs[i];
+            doNotOptimize(value--);
+            doNotOptimize(value);
+        });
+        // Float operands on either side
+        measure("float + Fraction", INPUT_SIZE, [&](size_t i) { doNotOptimize(floats[i] + rhs[i]); });
+        measure("Fraction + float", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] + floats[i]); });
+        measure("float / Fraction", INPUT_SIZE, [&](size_t i) { doNotOptimize(floats[i] / rhs[i]); });
+        measure("float < Fraction", INPUT_SIZE, [&](size_t i) { doNotOptimize(floats[i] < rhs[i]); });
+        measure("float == Fraction", INPUT_SIZE, [&](size_t i) { doNotOptimize(floats[i] == rhs[i]); });
+        measure("operator<<", INPUT_SIZE, [&](size_t i) {
+            ostringstream stream;
+            stream << lhs[i];
+            doNotOptimize(stream.str().size());
+        });
+        measure("operator>>", INPUT_SIZE, [&](size_t i) {
+            istringstream stream(texts[i]);
+            Fraction value;
+            stream >> value;
+            doNotOptimize(value);
+        });
+    }
+
+    // Calls that can't be inlined, like the calls into objects/Fraction.o before the class became constexpr
+    __attribute__((noinline)) int outOfLineNumerator(const Fraction &value) {
+        return value.getNumerator();
+    }
+
+    __attribute__((noinline)) bool outOfLineLess(const Fraction &lhs, const Fraction &rhs) {
+        return lhs < rhs;
+    }
+
+    __attribute__((noinline)) Fraction outOfLineAdd(const Fraction &lhs, const Fraction &rhs) {
+        return lhs + rhs;
+    }
+
+    void benchInlining() {
+        vector<Fraction> lhs = randomFractions(INPUT_SIZE, 1 << 12, 1);
+        vector<Fraction> rhs = randomFractions(INPUT_SIZE, 1 << 12, 2);
+        // Whole loops over the input, so that the inlined versions can also be vectorized
+        auto sum_numerators = [&](auto numerator) {
+            long sum = 0;
+            for (const Fraction &value: lhs) {
+                sum += numerator(value);
+            }
+            return sum;
+        };
+        auto count_less = [&](auto less) {
+            size_t count = 0;
+            for (size_t i = 0; i < lhs.size(); i++) {
+                count += static_cast<size_t>(less(lhs[i], rhs[i]));
+            }
+            return count;
+        };
+        measure("getNumerator sum of 4096 (out of line)", 1,
+                [&](size_t) { doNotOptimize(sum_numerators(outOfLineNumerator)); });
+        measure("getNumerator sum of 4096 (inlined)", 1,
+                [&](size_t) { doNotOptimize(sum_numerators([](const Fraction &value) { return value.getNumerator(); })); });
+        measure("compare 4096 pairs (out of line)", 1, [&](size_t) { doNotOptimize(count_less(outOfLineLess)); });
+        measure("compare 4096 pairs (inlined)", 1, [&](size_t) {
+            doNotOptimize(count_less([](const Fraction &left, const Fraction &right) { return left < right; }));
+        });
+        measure("add (out of line)", INPUT_SIZE, [&](size_t i) { doNotOptimize(outOfLineAdd(lhs[i], rhs[i])); });
+        measure("add (inlined)", INPUT_SIZE, [&](size_t i) { doNotOptimize(lhs[i] + rhs[i]); });
+        // Folded by the compiler, nothing is left to run
+        constexpr Fraction folded = Fraction(1, 3) + Fraction(1, 6);
+        measure("add of constants (folded)", INPUT_SIZE, [&](size_t) { doNotOptimize(folded); });
+    }
+
+    void benchChecked() {
+        // One addition in a hundred overflows
+        const size_t overflow_period = 100;
+        vector<Fraction> lhs = randomFractions(INPUT_SIZE, 1 << 12, 1);
+        vector<Fraction> rhs = randomFractions(INPUT_SIZE, 1 << 12, 2);
+        for (size_t i = 0; i < INPUT_SIZE; i += overflow_period) {
+            lhs[i] = Fraction(numeric_limits<int>::max(), 1);
+            rhs[i] = Fraction(1, 1);
+        }
+        measure("add, 1% overflow (exceptions)", INPUT_SIZE, [&](size_t i) {
+            try {
+                doNotOptimize(lhs[i] + rhs[i]);
+            } catch (const overflow_error &) {
+                doNotOptimize(i);
+            }
+        });
+        measure("add, 1% overflow (checked_add)", INPUT_SIZE, [&](size_t i) {
+            CheckedResult<Fraction> sum = checked_add(lhs[i], rhs[i]);
+            if (sum) {
+                doNotOptimize(*sum);
+            } else {
+                doNotOptimize(i);
+            }
+        });
+        // Whole loops, which the compiler can only optimize across iterations if nothing throws
+        measure("count valid sums of 4096 (exceptions)", 1, [&](size_t) {
+            size_t valid = 0;
+            for (size_t i = 0; i < INPUT_SIZE; i++) {
+                try {
+                    doNotOptimize(lhs[i] + rhs[i]);
+                    valid++;
+                } catch (const overflow_error &) {
+                }
+            }
+            doNotOptimize(valid);
+        });
+        measure("count valid sums of 4096 (checked_add)", 1, [&](size_t) {
+            size_t valid = 0;
+            for (size_t i = 0; i < INPUT_SIZE; i++) {
+                valid += static_cast<size_t>(checked_add(lhs[i], rhs[i]).has_value());
+            }
+            doNotOptimize(valid);
+        });
+    }
+
+    // Adds pairs of fractions with the given overflow policy, one addition in a hundred overflows
+    template<OverflowPolicy Policy>
+    void measurePolicy(const string &name) {
+        using PolicyFraction = BasicFraction<int, Policy>;
+        const size_t overflow_period = 100;
+        vector<Fraction> lhs_values = randomFractions(INPUT_SIZE, 1 << 12, 1);
+        vector<Fraction> rhs_values = randomFractions(INPUT_SIZE, 1 << 12, 2);
+        vector<PolicyFraction> lhs(lhs_values.begin(), lhs_values.end());
+        vector<PolicyFraction> rhs(rhs_values.begin(), rhs_values.end());
+        for (size_t i = 0; i < INPUT_SIZE; i += overflow_period) {
+            lhs[i] = PolicyFraction(numeric_limits<int>::max(), 1);
+            rhs[i] = PolicyFraction(1, 1);
+        }
+        measure(name, INPUT_SIZE, [&](size_t i) {
+            try {
+                doNotOptimize(lhs[i] + rhs[i]);
+            } catch (const overflow_error &) {
+                doNotOptimize(i);
+            }
+        });
+    }
+
+    void benchPolicies() {
+        measurePolicy<OverflowPolicy::Throw>("add, 1% overflow (Throw)");
+        measurePolicy<OverflowPolicy::Saturate>("add, 1% overflow (Saturate)");
+        measurePolicy<OverflowPolicy::Promote>("add, 1% overflow (Promote)");
+        measurePolicy<OverflowPolicy::Unchecked>("add, 1% overflow (Unchecked)");
+    }
+
+    // Sorts a copy of the input once per round and records the time per sort
+    template<typename Compare>
+    void measureSort(const string &name, const vector<Fraction> &input, Compare compare) {
+        const int sort_rounds = 5;
+        vector<Fraction> data = input;
+        std::sort(data.begin(), data.end(), compare);
+        vector<double> samples;
+        for (int round = 0; round < sort_rounds; round++) {
+            data = input;
+            auto start = chrono::steady_clock::now();
+            std::sort(data.begin(), data.end(), compare);
+            samples.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+            doNotOptimize(data.front());
+        }
+        record(name, "ms/sort", std::move(samples));
+    }
+
+    void benchComparison() {
+        const size_t sort_size = 1000000;
+        vector<Fraction> input = randomFractions(sort_size, 1 << 20, 3);
+        // The float based operator< used before the exact rewrite, kept as a baseline
+        measureSort("sort 1M (float baseline)", input, [](const Fraction &lhs, const Fraction &rhs) {
+            return (float) lhs.getNumerator() / lhs.getDenominator() <
+                   (float) rhs.getNumerator() / rhs.getDenominator();
+        });
+        measureSort("sort 1M (exact)", input, [](const Fraction &lhs, const Fraction &rhs) { return lhs < rhs; });
+    }
+
+    // Sums the inputs into a BigFraction accumulator after one untimed sum and records the time per term
+    void measureBigSum(const string &name, const vector<BigFraction> &terms) {
+        const int sum_rounds = 5;
+        BigFraction warmup;
+        for (const BigFraction &term: terms) {
+            warmup += term;
+        }
+        doNotOptimize(warmup);
+        vector<double> samples;
+        for (int round = 0; round < sum_rounds; round++) {
+            auto start = chrono::steady_clock::now();
+            BigFraction sum;
+            for (const BigFraction &term: terms) {
+                sum += term;
+            }
+            auto elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            doNotOptimize(sum);
+            samples.push_back(elapsed / static_cast<double>(terms.size()));
+        }
+        record(name + (warmup.isInline() ? " (inline result)" : " (heap result)"), "ns/term", std::move(samples));
+    }
+
+    void benchBigFraction() {
+        // Values whose running sum stays within 64 bits never touch the heap
+        const size_t small_terms = 100000;
+        vector<BigFraction> dyadic;
+        for (size_t i = 0; i < small_terms; i++) {
+            dyadic.emplace_back(static_cast<int>(i % 7) - 3, 1 << (i % 10));
+        }
+        measureBigSum("BigFraction sum, small values", dyadic);
+
+        // The harmonic series outgrows Fraction after 23 terms and keeps growing
+        const int harmonic_terms = 2000;
+        vector<BigFraction> harmonic;
+        for (int k = 1; k <= harmonic_terms; k++) {
+            harmonic.emplace_back(1, k);
+        }
+        measureBigSum("BigFraction sum, harmonic series", harmonic);
+    }
+
+    // Runs a gcd kernel over pairs of inputs
+    template<typename UIntT, typename Kernel>
+    void measureGcd(const string &name, const vector<pair<UIntT, UIntT>> &inputs, Kernel kernel) {
+        measure(name, inputs.size(), [&](size_t i) { doNotOptimize(kernel(inputs[i].first, inputs[i].second)); });
+    }
+
+    // Random pairs and consecutive Fibonacci pairs (the worst case of Euclid's algorithm)
+    template<typename UIntT>
+    pair<vector<pair<UIntT, UIntT>>, vector<pair<UIntT, UIntT>>> gcdInputs(size_t count) {
+        mt19937_64 engine(4);
+        vector<pair<UIntT, UIntT>> random_pairs;
+        vector<pair<UIntT, UIntT>> fibonacci_pairs;
+        UIntT previous = 1;
+        UIntT current = 1;
+        while (current >= previous) {
+            fibonacci_pairs.emplace_back(current, previous);
+            UIntT next = previous + current;
+            previous = current;
+            current = next;
+        }
+        vector<pair<UIntT, UIntT>> largest(fibonacci_pairs.end() - 8, fibonacci_pairs.end());
+        fibonacci_pairs.clear();
+        for (size_t i = 0; i < count; i++) {
+            UIntT lhs = 0;
+            UIntT rhs = 0;
+            for (size_t word = 0; word < sizeof(UIntT); word += sizeof(uint64_t)) {
+                lhs = static_cast<UIntT>((static_cast<uint128_t>(lhs) << 32U << 32U) | engine());
+                rhs = static_cast<UIntT>((static_cast<uint128_t>(rhs) << 32U << 32U) | engine());
+            }
+            random_pairs.emplace_back(lhs, rhs);
+            fibonacci_pairs.push_back(largest[i % largest.size()]);
+        }
+        return {random_pairs, fibonacci_pairs};
+    }
+
+    void benchGcd() {
+        auto [random32, fibonacci32] = gcdInputs<uint32_t>(INPUT_SIZE);
+        auto [random64, fibonacci64] = gcdInputs<uint64_t>(INPUT_SIZE);
+        auto [random128, fibonacci128] = gcdInputs<uint128_t>(INPUT_SIZE);
+        auto std_gcd = [](auto lhs, auto rhs) { return std::gcd(lhs, rhs); };
+        auto euclid = [](auto lhs, auto rhs) { return euclidGcd(lhs, rhs); };
+        auto binary = [](auto lhs, auto rhs) { return binaryGcd(lhs, rhs); };
+        auto lehmer = [](uint128_t lhs, uint128_t rhs) { return lehmerGcd(lhs, rhs); };
+        measureGcd("gcd 32 random (std::gcd)", random32, std_gcd);
+        measureGcd("gcd 32 random (binary)", random32, binary);
+        measureGcd("gcd 32 fibonacci (std::gcd)", fibonacci32, std_gcd);
+        measureGcd("gcd 32 fibonacci (binary)", fibonacci32, binary);
+        measureGcd("gcd 64 random (std::gcd)", random64, std_gcd);
+        measureGcd("gcd 64 random (binary)", random64, binary);
+        measureGcd("gcd 64 fibonacci (std::gcd)", fibonacci64, std_gcd);
+        measureGcd("gcd 64 fibonacci (binary)", fibonacci64, binary);
+        measureGcd("gcd 128 random (euclid)", random128, euclid);
+        measureGcd("gcd 128 random (binary)", random128, binary);
+        measureGcd("gcd 128 random (lehmer)", random128, lehmer);
+        measureGcd("gcd 128 fibonacci (euclid)", fibonacci128, euclid);
+        measureGcd("gcd 128 fibonacci (binary)", fibonacci128, binary);
+        measureGcd("gcd 128 fibonacci (lehmer)", fibonacci128, lehmer);
+    }
+
+    void benchConversion() {
+        // Sensor style readings with 3 decimals
+        mt19937 engine(5);
+        uniform_int_distribution<int> thousandths(-100000, 100000);
+        vector<float> readings;
+        vector<double> doubles;
+        for (size_t i = 0; i < INPUT_SIZE; i++) {
+            readings.push_back(static_cast<float>(thousandths(engine)) / 1000);
+            doubles.push_back(static_cast<double>(readings.back()));
+        }
+        measure("float to Fraction (constructor)", INPUT_SIZE, [&](size_t i) { doNotOptimize(Fraction(readings[i])); });
+        measure("float to Fraction (from_float)", INPUT_SIZE,
+                [&](size_t i) { doNotOptimize(Fraction::from_float(readings[i])); });
+        measure("double to Fraction (from_double, 1000)", INPUT_SIZE,
+                [&](size_t i) { doNotOptimize(Fraction::from_double(doubles[i], 1000)); });
+        measure("double to Fraction64 (from_double_exact)", INPUT_SIZE,
+                [&](size_t i) { doNotOptimize(Fraction64::from_double_exact(doubles[i])); });
+    }
+
+    void benchText() {
+        vector<Fraction> input = randomFractions(INPUT_SIZE, 1 << 30, 6);
+        vector<string> texts;
+        for (const Fraction &fraction: input) {
+            char text[Fraction::MAX_CHARS];
+            texts.emplace_back(text, ariel::to_chars(text, text + sizeof(text), fraction).ptr);
+        }
+        vector<string> spaced = texts;
+        for (string &text: spaced) {
+            replace(text.begin(), text.end(), '/', ' ');
+        }
+        // The ostream insertions operator<< used before the charconv rewrite, kept as a baseline
+        measure("format (ostream baseline)", INPUT_SIZE, [&](size_t i) {
+            ostringstream stream;
+            stream << input[i].getNumerator() << "/" << input[i].getDenominator();
+            doNotOptimize(stream.str().size());
+        });
+        measure("format (to_chars)", INPUT_SIZE, [&](size_t i) {
+            char text[Fraction::MAX_CHARS];
+            doNotOptimize(ariel::to_chars(text, text + sizeof(text), input[i]).ptr);
+        });
+        measure("parse (istream baseline)", INPUT_SIZE, [&](size_t i) {
+            istringstream stream(spaced[i]);
+            int numerator = 0;
+            int denominator = 0;
+            stream >> numerator >> denominator;
+            doNotOptimize(Fraction(numerator, denominator));
+        });
+        measure("parse (operator>>)", INPUT_SIZE, [&](size_t i) {
+            istringstream stream(spaced[i]);
+            Fraction fraction;
+            stream >> fraction;
+            doNotOptimize(fraction);
+        });
+        measure("parse (from_chars)", INPUT_SIZE, [&](size_t i) {
+            Fraction fraction;
+            ariel::from_chars(texts[i].data(), texts[i].data() + texts[i].size(), fraction);
+            doNotOptimize(fraction);
+        });
+    }
+
+    // Runs body, which processes count elements, once for warmup and then REPETITIONS times, and records
+    // the throughput in millions of elements per second
+    template<typename Body>
+    void measureThroughput(const string &name, size_t count, Body body) {
+        body();
+        vector<double> samples;
+        for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+            auto start = chrono::steady_clock::now();
+            body();
+            auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            samples.push_back(static_cast<double>(count) / elapsed / 1e6);
+        }
+        record(name, "M elements/s", std::move(samples));
+    }
+
+    void benchVector() {
+        const size_t count = 1 << 16;
+        vector<Fraction> lhs = randomFractions(count, 1 << 12, 7);
+        vector<Fraction> rhs = randomFractions(count, 1 << 12, 8);
+        vector<Fraction> output(count);
+        FractionVector left(lhs);
+        FractionVector right(rhs);
+        const pair<FractionVector::SimdLevel, string> levels[] = {{FractionVector::SimdLevel::Scalar, "scalar"},
+                                                                  {FractionVector::SimdLevel::Sse4,   "SSE4"},
+                                                                  {FractionVector::SimdLevel::Avx2,   "AVX2"}};
+        const FractionVector::SimdLevel original = FractionVector::simdLevel();
+        measureThroughput("add (Fraction loop)", count, [&] {
+            for (size_t i = 0; i < count; i++) {
+                output[i] = lhs[i] + rhs[i];
+            }
+            doNotOptimize(output.front());
+        });
+        for (const auto &[level, level_name]: levels) {
+            if (level <= FractionVector::supportedSimdLevel()) {
+                FractionVector::setSimdLevel(level);
+                measureThroughput("add (FractionVector, " + level_name + ")", count,
+                                  [&] { doNotOptimize(left.add(right).numerators()[0]); });
+            }
+        }
+        measureThroughput("mul (Fraction loop)", count, [&] {
+            for (size_t i = 0; i < count; i++) {
+                output[i] = lhs[i] * rhs[i];
+            }
+            doNotOptimize(output.front());
+        });
+        for (const auto &[level, level_name]: levels) {
+            if (level <= FractionVector::supportedSimdLevel()) {
+                FractionVector::setSimdLevel(level);
+                measureThroughput("mul (FractionVector, " + level_name + ")", count,
+                                  [&] { doNotOptimize(left.mul(right).numerators()[0]); });
+            }
+        }
+        vector<int> order(count);
+        measureThroughput("compare (Fraction loop)", count, [&] {
+            for (size_t i = 0; i < count; i++) {
+                order[i] = lhs[i] < rhs[i] ? -1 : (lhs[i] == rhs[i] ? 0 : 1);
+            }
+            doNotOptimize(order.front());
+        });
+        for (const auto &[level, level_name]: levels) {
+            if (level <= FractionVector::supportedSimdLevel()) {
+                FractionVector::setSimdLevel(level);
+                measureThroughput("compare (FractionVector, " + level_name + ")", count,
+                                  [&] { doNotOptimize(left.compare(right).front()); });
+            }
+        }
+        FractionVector::setSimdLevel(original);
+    }
+
+    void benchCompact() {
+        // Large enough that neither table fits in the caches: 64 MB of Fraction, 32 MB packed
+        const size_t count = 1 << 23;
+        vector<Fraction> table = randomFractions(count, 1 << 14, 9);
+        CompactFractionVector compact_table(table);
+        const Fraction threshold(1, 3);
+        const CompactFraction compact_threshold(threshold);
+        measureThroughput("scan count < 1/3 (vector<Fraction>)", count, [&] {
+            size_t below = 0;
+            for (const Fraction &value: table) {
+                below += static_cast<size_t>(value < threshold);
+            }
+            doNotOptimize(below);
+        });
+        measureThroughput("scan count < 1/3 (CompactFractionVector)", count, [&] {
+            size_t below = 0;
+            for (CompactFraction value: compact_table) {
+                below += static_cast<size_t>(value < compact_threshold);
+            }
+            doNotOptimize(below);
+        });
+        // Unpacking every element to Fraction, as code written against Fraction does
+        measureThroughput("scan count < 1/3 (CompactFractionVector, as Fraction)", count, [&] {
+            size_t below = 0;
+            for (size_t i = 0; i < compact_table.size(); i++) {
+                below += static_cast<size_t>(compact_table[i] < threshold);
+            }
+            doNotOptimize(below);
+        });
+        measureThroughput("scan sum of numerators (vector<Fraction>)", count, [&] {
+            long sum = 0;
+            for (const Fraction &value: table) {
+                sum += value.getNumerator();
+            }
+            doNotOptimize(sum);
+        });
+        measureThroughput("scan sum of numerators (CompactFractionVector)", count, [&] {
+            long sum = 0;
+            for (CompactFraction value: compact_table) {
+                sum += value.getNumerator();
+            }
+            doNotOptimize(sum);
+        });
+    }
+
+    // Runs body, a whole workload too long to repeat often, the given number of times and records the
+    // time of each run. There is no separate warmup, the median leaves out a slow first run.
+    template<typename Body>
+    void measureRuns(const string &name, int runs, Body body) {
+        vector<double> samples;
+        for (int run = 0; run < runs; run++) {
+            auto start = chrono::steady_clock::now();
+            body();
+            samples.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        }
+        record(name, "ms", std::move(samples));
+    }
+
+    void benchHashing() {
+        // 10^7 keys with about 4 million distinct values
+        const size_t count = 10000000;
+        vector<Fraction> keys = randomFractions(count, 2000, 10);
+        measureRuns("dedup 10^7 keys (std::unordered_set)", 3, [&] {
+            unordered_set<Fraction> unique;
+            for (const Fraction &key: keys) {
+                unique.insert(key);
+            }
+            doNotOptimize(unique.size());
+        });
+        measureRuns("dedup 10^7 keys (FractionHashSet)", 3, [&] {
+            FractionHashSet unique;
+            for (const Fraction &key: keys) {
+                unique.insert(key);
+            }
+            doNotOptimize(unique.size());
+        });
+        // Group by value, counting the occurrences of each key
+        measureRuns("group-by 10^7 keys (std::unordered_map)", 3, [&] {
+            unordered_map<Fraction, int> groups;
+            for (const Fraction &key: keys) {
+                groups[key]++;
+            }
+            doNotOptimize(groups.size());
+        });
+        measureRuns("group-by 10^7 keys (FractionHashMap)", 3, [&] {
+            FractionHashMap<int> groups;
+            for (const Fraction &key: keys) {
+                groups[key]++;
+            }
+            doNotOptimize(groups.size());
+        });
+    }
+
+    // Sorts copies of the input and records the time per sort
+    template<typename Sort>
+    void measureSortSize(const string &name, const vector<Fraction> &input, Sort sortCopy) {
+        // Small inputs are sorted repeatedly, about 10^6 elements in total
+        size_t rounds = max<size_t>(1, 1000000 / input.size());
+        vector<double> samples;
+        vector<Fraction> data;
+        for (size_t round = 0; round < rounds; round++) {
+            data = input;
+            auto start = chrono::steady_clock::now();
+            sortCopy(data);
+            samples.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+            doNotOptimize(data.front());
+        }
+        record(name + " " + to_string(input.size()), "ms/sort", std::move(samples));
+    }
+
+    void benchSort() {
+        // Each hardware thread gets a bucket; on a single core machine the parallel runs show the overhead
+        const SortOptions parallel{};
+        const SortOptions keyed{.threads = 0, .precompute_keys = true};
+        for (size_t size = 1000; size <= 10000000; size *= 10) {
+            vector<Fraction> input = randomFractions(size, 1 << 20, 16);
+            measureSortSize("std::sort", input, [](vector<Fraction> &data) { std::sort(data.begin(), data.end()); });
+            measureSortSize("ariel::sort (1 thread)", input, [](vector<Fraction> &data) {
+                ariel::sort(data, {.threads = 1});
+            });
+            measureSortSize("ariel::sort (parallel)", input, [&](vector<Fraction> &data) {
+                ariel::sort(data, parallel);
+            });
+            measureSortSize("ariel::sort (keys)", input, [&](vector<Fraction> &data) { ariel::sort(data, keyed); });
+        }
+        // Top-100 of 10^7
+        vector<Fraction> input = randomFractions(10000000, 1 << 20, 17);
+        measureSortSize("top-100 partial_sort", input, [](vector<Fraction> &data) {
+            ariel::partial_sort(data, 100);
+        });
+        measureSortSize("median nth_element", input, [](vector<Fraction> &data) {
+            ariel::nth_element(data, data.size() / 2);
+        });
+    }
+
+    void benchReduce() {
+        // Denominators up to 60 keep the common denominator within 128 bits; summing these as Fraction
+        // overflows within a few terms, so the baseline accumulates into a BigFraction
+        const size_t count = 100000000;
+        mt19937 engine(18);
+        uniform_int_distribution<int> numerators(-1000000, 1000000);
+        uniform_int_distribution<int> denominators(1, 60);
+        vector<Fraction> values;
+        values.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            values.emplace_back(numerators(engine), denominators(engine));
+        }
+        const size_t baseline_count = count / 100;
+        measureRuns("sum 10^6 (BigFraction +=)", 3, [&] {
+            BigFraction total;
+            for (size_t i = 0; i < baseline_count; i++) {
+                total += values[i];
+            }
+            doNotOptimize(total);
+        });
+        for (unsigned threads: {1U, 2U, 4U, 0U}) {
+            string name = threads == 0 ? "all threads" : to_string(threads) + (threads == 1 ? " thread" : " threads");
+            measureRuns("sum 10^8 (" + name + ")", 3, [&] {
+                doNotOptimize(ariel::sum(values, {.threads = threads}));
+            });
+        }
+        // Weighted sum with integer weights
+        uniform_int_distribution<int> weight(1, 1000);
+        vector<Fraction> weights;
+        weights.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            weights.emplace_back(weight(engine), 1);
+        }
+        measureRuns("dot 10^8 (all threads)", 3, [&] { doNotOptimize(ariel::dot(values, weights)); });
+    }
+
+    void benchLazy() {
+        vector<Fraction> a = randomFractions(INPUT_SIZE, 1 << 6, 19);
+        vector<Fraction> b = randomFractions(INPUT_SIZE, 1 << 6, 20);
+        vector<Fraction> c = randomFractions(INPUT_SIZE, 1 << 6, 21);
+        vector<Fraction> d = randomFractions(INPUT_SIZE, 1 << 6, 22);
+        // (a + b - c * d) / a, observed once by a comparison or by converting back to Fraction
+        measure("a+b-c*d / a, compare (eager)", INPUT_SIZE, [&](size_t i) {
+            doNotOptimize((a[i] + b[i] - c[i] * d[i]) / a[i] < b[i]);
+        });
+        measure("a+b-c*d / a, compare (lazy)", INPUT_SIZE, [&](size_t i) {
+            doNotOptimize((LazyFraction(a[i]) + b[i] - c[i] * LazyFraction(d[i])) / a[i] < b[i]);
+        });
+        measure("a+b-c*d / a, toFraction (lazy)", INPUT_SIZE, [&](size_t i) {
+            doNotOptimize(((LazyFraction(a[i]) + b[i] - c[i] * LazyFraction(d[i])) / a[i]).toFraction());
+        });
+        // 64-term running sums observed only at the end, power of two denominators keep the eager sums in range
+        const size_t chain = 64;
+        vector<Fraction> steps;
+        for (size_t i = 0; i < INPUT_SIZE; i++) {
+            steps.emplace_back(a[i].getNumerator(), 1 << (i % 7));
+        }
+        measure("64-term chain (eager)", INPUT_SIZE / chain, [&](size_t i) {
+            Fraction sum;
+            for (size_t j = i * chain; j < (i + 1) * chain; j++) {
+                sum = sum + steps[j];
+            }
+            doNotOptimize(sum);
+        });
+        measure("64-term chain (lazy)", INPUT_SIZE / chain, [&](size_t i) {
+            LazyFraction sum;
+            for (size_t j = i * chain; j < (i + 1) * chain; j++) {
+                sum += steps[j];
+            }
+            doNotOptimize(sum.toFraction());
+        });
+    }
+    void benchExpressions() {
+        // Degree 5 polynomials in Horner form, small terms keep the eager intermediates in range
+        vector<Fraction> x = randomFractions(INPUT_SIZE, 1 << 3, 23);
+        vector<vector<Fraction>> c;
+        for (unsigned k = 0; k < 6; k++) {
+            c.push_back(randomFractions(INPUT_SIZE, 1 << 3, 24 + k));
+        }
+        measure("degree 5 polynomial (eager)", INPUT_SIZE, [&](size_t i) {
+            doNotOptimize(((((c[5][i] * x[i] + c[4][i]) * x[i] + c[3][i]) * x[i] + c[2][i]) * x[i] + c[1][i]) * x[i] +
+                          c[0][i]);
+        });
+        measure("degree 5 polynomial (expression template)", INPUT_SIZE, [&](size_t i) {
+            Fraction value = ((((expr(c[5][i]) * x[i] + c[4][i]) * x[i] + c[3][i]) * x[i] + c[2][i]) * x[i] +
+                              c[1][i]) * x[i] + c[0][i];
+            doNotOptimize(value);
+        });
+        // Integer coefficients share the denominators of the powers of x
+        measure("x^3 - 2x^2 + 3x - 4 (eager)", INPUT_SIZE, [&](size_t i) {
+            doNotOptimize(((x[i] - Fraction(2, 1)) * x[i] + Fraction(3, 1)) * x[i] - Fraction(4, 1));
+        });
+        measure("x^3 - 2x^2 + 3x - 4 (expression template)", INPUT_SIZE, [&](size_t i) {
+            doNotOptimize(Fraction(((expr(x[i]) - 2) * x[i] + 3) * x[i] - 4));
+        });
+    }
+
+    // The locked Fraction that AtomicFraction replaces
+    class LockedFraction {
+    private:
+        mutable mutex lock;
+        Fraction value;
+
+    public:
+        Fraction fetch_add(const Fraction &other) {
+            lock_guard<mutex> guard(lock);
+            Fraction previous = value;
+            value = value + other;
+            return previous;
+        }
+
+        Fraction load() const {
+            lock_guard<mutex> guard(lock);
+            return value;
+        }
+    };
+
+    // Splits updates calls of add(value) over the given number of threads, adding 1/3 and -1/3 in turn so that
+    // a shared Fraction stays small
+    template<typename Add>
+    void contend(unsigned threads, size_t updates, Add add) {
+        vector<thread> workers;
+        for (unsigned worker = 0; worker < threads; worker++) {
+            workers.emplace_back([&add, count = updates / threads] {
+                for (size_t i = 0; i < count; i++) {
+                    add(i % 2 == 0 ? Fraction(1, 3) : Fraction(-1, 3));
+                }
+            });
+        }
+        for (thread &worker: workers) {
+            worker.join();
+        }
+    }
+
+    string threadSuffix(unsigned threads) {
+        return " (" + to_string(threads) + (threads == 1 ? " thread)" : " threads)");
+    }
+
+    void benchAtomic() {
+        // All threads update one shared value, so the time includes the contention on its cache line. On a
+        // single core the threads only take turns and the two versions cost about the same.
+        const size_t updates = 1 << 18;
+        for (unsigned threads = 1; threads <= 64; threads *= 2) {
+            LockedFraction locked;
+            measureThroughput("fetch_add, mutex" + threadSuffix(threads), updates, [&] {
+                contend(threads, updates, [&](const Fraction &value) { locked.fetch_add(value); });
+                doNotOptimize(locked.load());
+            });
+            AtomicFraction atomic;
+            measureThroughput("fetch_add, AtomicFraction" + threadSuffix(threads), updates, [&] {
+                contend(threads, updates, [&](const Fraction &value) { atomic.fetch_add(value); });
+                doNotOptimize(atomic.load());
+            });
+        }
+    }
+
+    void benchSharded() {
+        // Every thread adds into its own shard, so with one core per thread the throughput grows with the
+        // threads; on a single core they only take turns
+        const size_t updates = 1 << 18;
+        for (unsigned threads = 1; threads <= 64; threads *= 2) {
+            LockedFraction locked;
+            measureThroughput("add, mutex" + threadSuffix(threads), updates, [&] {
+                contend(threads, updates, [&](const Fraction &value) { locked.fetch_add(value); });
+                doNotOptimize(locked.load());
+            });
+            ShardedFractionAccumulator sharded(threads);
+            measureThroughput("add, ShardedFractionAccumulator" + threadSuffix(threads), updates, [&] {
+                contend(threads, updates, [&](const Fraction &value) { sharded.add(value); });
+                doNotOptimize(sharded.snapshot());
+            });
+        }
+    }
+
+    void benchFiles() {
+        // 2^27 fractions, 1 GB as Fraction, about 1.3 GB as text and 1 GB as columns. Both files are read
+        // right after being written, so they come from the page cache rather than the disk. The denominators
+        // are those of the reduce benchmark, so that the sum stays within 128 bits.
+        const size_t count = size_t{1} << 27;
+        mt19937 engine(21);
+        uniform_int_distribution<int> numerators(-1000000, 1000000);
+        uniform_int_distribution<int> denominators(1, 60);
+        vector<Fraction> values;
+        values.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            values.emplace_back(numerators(engine), denominators(engine));
+        }
+        string text_path = (filesystem::temp_directory_path() / "bench_fractions.txt").string();
+        string columnar_path = (filesystem::temp_directory_path() / "bench_fractions.frac").string();
+        measureRuns("write 2^27 (operator<<)", 1, [&] {
+            ofstream out(text_path);
+            for (const Fraction &value: values) {
+                out << value << ' ';
+            }
+        });
+        measureRuns("write 2^27 (FractionFileWriter)", 1, [&] {
+            FractionFileWriter writer(columnar_path);
+            writer.write(values);
+            writer.close();
+        });
+        cout << "text " << filesystem::file_size(text_path) / 1000000 << " MB, columnar "
+             << filesystem::file_size(columnar_path) / 1000000 << " MB" << endl;
+        // Only one copy of the data is kept in memory at a time
+        vector<Fraction>().swap(values);
+        vector<Fraction> loaded;
+        loaded.reserve(count);
+        measureRuns("load 2^27 into a vector (operator>>)", 1, [&] {
+            loaded.clear();
+            ifstream in(text_path);
+            Fraction value;
+            for (size_t i = 0; i < count; i++) {
+                in >> value;
+                loaded.push_back(value);
+            }
+            doNotOptimize(loaded.back());
+        });
+        measureRuns("load 2^27 into a vector (FractionFileReader)", 1, [&] {
+            loaded.clear();
+            FractionFileReader reader(columnar_path);
+            for (size_t i = 0; i < reader.chunkCount(); i++) {
+                FractionChunk chunk = reader.chunk(i);
+                for (size_t j = 0; j < chunk.size(); j++) {
+                    loaded.push_back(chunk[j]);
+                }
+            }
+            doNotOptimize(loaded.back());
+        });
+        // Zero copy: the mapped columns go straight into the sum
+        measureRuns("open and sum 2^27 in place (FractionFileReader)", 3, [&] {
+            FractionFileReader reader(columnar_path);
+            BigFraction total;
+            for (size_t i = 0; i < reader.chunkCount(); i++) {
+                FractionChunk chunk = reader.chunk(i);
+                total += ariel::sum(chunk.numerators, chunk.denominators, {.threads = 1});
+            }
+            doNotOptimize(total);
+        });
+        filesystem::remove(text_path);
+        filesystem::remove(columnar_path);
+    }
+
+    // Runs body, which produces the given number of bytes, like measureThroughput and records gigabytes per second
+    template<typename Body>
+    void measureBandwidth(const string &name, size_t bytes, Body body) {
+        body();
+        vector<double> samples;
+        for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+            auto start = chrono::steady_clock::now();
+            body();
+            auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            samples.push_back(static_cast<double>(bytes) / elapsed / 1e9);
+        }
+        record(name, "GB/s", std::move(samples));
+    }
+
+    void benchCodec() {
+        // 2^22 fractions of each distribution, 32 MB as Fraction. Decoding speed is measured in bytes of
+        // decoded fractions, 8 per fraction.
+        const size_t count = size_t{1} << 22;
+        mt19937 engine(25);
+        uniform_int_distribution<int> cents(1, 100000);
+        uniform_int_distribution<int> small_numerators(-100, 100);
+        uniform_int_distribution<int> small_denominators(1, 100);
+        vector<pair<string, vector<Fraction>>> distributions(4);
+        distributions[0].first = "prices";
+        distributions[1].first = "small terms";
+        distributions[2].first = "grouped by denominator";
+        distributions[3].first = "30-bit terms";
+        for (size_t i = 0; i < count; i++) {
+            // Amounts in cents reduce to denominators dividing 100
+            distributions[0].second.emplace_back(cents(engine), 100);
+            distributions[1].second.emplace_back(small_numerators(engine), small_denominators(engine));
+        }
+        distributions[2].second = distributions[1].second;
+        vector<Fraction> &grouped = distributions[2].second;
+        stable_sort(grouped.begin(), grouped.end(), [](const Fraction &lhs, const Fraction &rhs) {
+            return lhs.getDenominator() < rhs.getDenominator();
+        });
+        distributions[3].second = randomFractions(count, 1 << 30, 26);
+        const pair<FractionVector::SimdLevel, string> levels[] = {{FractionVector::SimdLevel::Scalar, "scalar"},
+                                                                  {FractionVector::SimdLevel::Sse4,   "SSE4"}};
+        const FractionVector::SimdLevel original = FractionVector::simdLevel();
+        const size_t decoded_bytes = count * sizeof(Fraction);
+        for (const auto &[name, values]: distributions) {
+            vector<uint8_t> bytes = encode_fractions(values);
+            record("compression ratio (" + name + ")", "x",
+                   {static_cast<double>(decoded_bytes) / static_cast<double>(bytes.size())});
+            FractionVector columns;
+            for (const auto &[level, level_name]: levels) {
+                if (level <= FractionVector::supportedSimdLevel()) {
+                    FractionVector::setSimdLevel(level);
+                    measureBandwidth("decode " + name + " (FractionVector, " + level_name + ")", decoded_bytes, [&] {
+                        decode_fractions(bytes, columns);
+                        doNotOptimize(columns.numerators()[0]);
+                    });
+                }
+            }
+            FractionVector::setSimdLevel(original);
+        }
+        const vector<Fraction> &small = distributions[1].second;
+        vector<uint8_t> small_bytes = encode_fractions(small);
+        measureBandwidth("decode small terms (vector<Fraction>)", decoded_bytes,
+                         [&] { doNotOptimize(decode_fractions(small_bytes).back()); });
+        measureThroughput("encode small terms", count, [&] { doNotOptimize(encode_fractions(small).size()); });
+    }
+
+    // Writes text as a JSON string literal
+    void writeJsonString(ostream &out, const string &text) {
+        out << '"';
+        for (char c: text) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out << "\\u" << hex << setw(4) << setfill('0') << static_cast<int>(c) << dec << setfill(' ');
+            } else {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+
+    // Writes every recorded result, so that runs on different commits can be compared by a script
+    void writeJson(ostream &out, const string &label) {
+        out << setprecision(numeric_limits<double>::max_digits10);
+        out << "{\n  \"label\": ";
+        writeJsonString(out, label);
+        out << ",\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result &result = results[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+            writeJsonString(out, result.name);
+            out << ", \"unit\": ";
+            writeJsonString(out, result.unit);
+            out << ", \"repetitions\": " << result.samples.size()
+                << ", \"median\": " << percentile(result.samples, 0.5)
+                << ", \"p10\": " << percentile(result.samples, 0.1)
+                << ", \"p90\": " << percentile(result.samples, 0.9)
+                << ", \"min\": " << result.samples.front()
+                << ", \"max\": " << result.samples.back() << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    struct Group {
+        const char *name;
+        void (*run)();
+    };
+
+    const Group GROUPS[] = {
+            {"addition",    benchAddition},
+            {"operators",   benchOperators},
+            {"inlining",    benchInlining},
+            {"checked",     benchChecked},
+            {"policies",    benchPolicies},
+            {"lazy",        benchLazy},
+            {"expressions", benchExpressions},
+            {"comparison",  benchComparison},
+            {"bigfraction", benchBigFraction},
+            {"gcd",         benchGcd},
+            {"conversion",  benchConversion},
+            {"text",        benchText},
+            {"vector",      benchVector},
+            {"compact",     benchCompact},
+            {"hashing",     benchHashing},
+            {"sort",        benchSort},
+            {"reduce",      benchReduce},
+            {"atomic",      benchAtomic},
+            {"sharded",     benchSharded},
+            {"files",       benchFiles},
+            {"codec",       benchCodec},
+    };
+}
+
+int main(int argc, char *argv[]) {
+    string filter;
+    string json_path;
+    string label;
+    bool list = false;
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--list") {
+            list = true;
+        } else if ((option == "--filter" || option == "--json" || option == "--label") && i + 1 < argc) {
+            string &value = option == "--filter" ? filter : option == "--json" ? json_path : label;
+            value = argv[++i];
+        } else {
+            cerr << "Usage: " << argv[0] << " [--list] [--filter TEXT] [--json FILE] [--label TEXT]" << endl;
+            return 1;
+        }
+    }
+    for (const Group &group: GROUPS) {
+        if (string(group.name).find(filter) == string::npos) {
+            continue;
+        }
+        if (list) {
+            cout << group.name << endl;
+            continue;
+        }
+        cout << "== " << group.name << endl;
+        group.run();
+    }
+    if (!json_path.empty()) {
+        ofstream out(json_path);
+        writeJson(out, label);
+        if (!out) {
+            cerr << "Could not write " << json_path << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,1888 @@
+#include <sstream>
+#include "doctest.h"
+#include "sources/AtomicFraction.hpp"
+#include "sources/Fraction.hpp"
+#include "sources/FractionCodec.hpp"
+#include "sources/FractionExpr.hpp"
+#include "sources/FractionFile.hpp"
+#include "sources/FractionHashMap.hpp"
+#include "sources/FractionReduce.hpp"
+#include "sources/FractionSort.hpp"
+#include "sources/FractionStats.hpp"
+#include "sources/BigFraction.hpp"
+#include "sources/CompactFraction.hpp"
+#include "sources/FractionVector.hpp"
+#include "sources/LazyFraction.hpp"
+#include "sources/ShardedFractionAccumulator.hpp"
+#include "sources/Gcd.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+using namespace ariel;
+
+TEST_SUITE("Overflow-free addition and subtraction") {
+
+    TEST_CASE("Results that fit after reduction do not throw") {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+
+        // max/2 + 1/2 = 2^31/2 = 2^30, the unreduced numerator overflows an int
+        CHECK_EQ(Fraction{max_int, 2} + Fraction{1, 2}, Fraction{1 << 30, 1});
+        CHECK_EQ(Fraction{min_int + 1, 2} - Fraction{1, 2}, Fraction{-(1 << 30), 1});
+
+        // Cross products overflow an int but the reduced sum is small
+        CHECK_EQ(Fraction{max_int - 1, max_int} + Fraction{1, max_int}, Fraction{1, 1});
+        CHECK_EQ(Fraction{1, max_int} - Fraction{1, max_int}, Fraction{0, 1});
+    }
+
+    TEST_CASE("Results that do not fit still throw") {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+
+        CHECK_THROWS_AS(Fraction(max_int, 1) + Fraction(1, 1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction(min_int, 1) - Fraction(1, 1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction(1, max_int) + Fraction(1, max_int - 1), std::overflow_error);
+        CHECK_NOTHROW(Fraction(max_int - 1, 1) + Fraction(1, 1));
+        CHECK_NOTHROW(Fraction(min_int + 1, 1) - Fraction(1, 1));
+    }
+}
+
+TEST_SUITE("Exact comparison operators") {
+
+    TEST_CASE("Large numerators that collapse to the same float are ordered correctly") {
+        // 2^24 + 1 is the first integer a float can't represent
+        Fraction big{16777217, 1};
+        Fraction smaller{16777216, 1};
+        CHECK_LT(smaller, big);
+        CHECK_GT(big, smaller);
+        CHECK_FALSE((big <= smaller));
+        CHECK_FALSE((smaller >= big));
+
+        int max_int = std::numeric_limits<int>::max();
+        CHECK_LT(Fraction(max_int - 2, max_int), Fraction(max_int - 1, max_int));
+        CHECK_LT(Fraction(-1, max_int), Fraction(-1, max_int - 1) * Fraction(-1, 1));
+    }
+
+    TEST_CASE("Three-way comparison") {
+        CHECK((Fraction{1, 3} <=> Fraction{1, 2}) == std::strong_ordering::less);
+        CHECK((Fraction{2, 4} <=> Fraction{1, 2}) == std::strong_ordering::equal);
+        CHECK((Fraction{-1, 3} <=> Fraction{-1, 2}) == std::strong_ordering::greater);
+        CHECK((Fraction{1, 2} <=> 0.5) == std::strong_ordering::equal);
+    }
+}
+
+TEST_SUITE("Exact equality") {
+
+    TEST_CASE("Fractions that agree in 3 decimals are not equal") {
+        CHECK_NE(Fraction{1, 3}, Fraction{333, 1000});
+        CHECK_NE(Fraction{1, 1000000}, Fraction{0, 1});
+        CHECK_NE(Fraction{1000001, 1000000}, Fraction{1, 1});
+    }
+
+    TEST_CASE("Large numerators are compared without overflow") {
+        int max_int = std::numeric_limits<int>::max();
+        CHECK_EQ(Fraction(max_int, 1), Fraction(max_int, 1));
+        CHECK_NE(Fraction(max_int, 1), Fraction(max_int - 1, 1));
+        CHECK_NE(Fraction(max_int, 3), Fraction(max_int - 1, 3));
+    }
+
+    TEST_CASE("approx_equal keeps the float semantics") {
+        CHECK(Fraction{1, 3}.approx_equal(0.333F));
+        CHECK_FALSE(Fraction{1, 3}.approx_equal(0.33F));
+        CHECK(Fraction{1, 3}.approx_equal(0.33F, 0.01F));
+        CHECK_EQ(Fraction{1, 3}, 0.333);
+        CHECK_EQ(0.333, Fraction{1, 3});
+    }
+
+    TEST_CASE("Dividing a float by a tiny fraction does not report division by zero") {
+        CHECK_EQ(1.0 / Fraction{1, 100000}, Fraction{100000, 1});
+    }
+}
+
+TEST_SUITE("BasicFraction widths") {
+
+    TEST_CASE("Fraction is the int instantiation") {
+        CHECK(std::is_same_v<Fraction, BasicFraction<int>>);
+        CHECK(sizeof(Fraction16) == 2 * sizeof(std::int16_t));
+        CHECK(sizeof(Fraction128) == 2 * sizeof(int128_t));
+    }
+
+    TEST_CASE("Narrow widths reduce and check their own range") {
+        Fraction8 a{6, -8};
+        CHECK_EQ(a.getNumerator(), -3);
+        CHECK_EQ(a.getDenominator(), 4);
+        CHECK_EQ(a + Fraction8{1, 4}, Fraction8{-1, 2});
+        CHECK_EQ(Fraction8{127, 2} + Fraction8{1, 2}, Fraction8{64, 1});
+        CHECK_THROWS_AS(Fraction8(127, 1) + Fraction8(1, 1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction8(64, 1) * Fraction8(2, 1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction8(0.125F), std::overflow_error);
+
+        Fraction16 b{30000, 7};
+        CHECK_LT(b, Fraction16{30001, 7});
+        CHECK_EQ(b - Fraction16{30000, 7}, Fraction16{});
+        CHECK_EQ(Fraction16{0.25F}, Fraction16{1, 4});
+    }
+
+    TEST_CASE("64-bit fractions use 128-bit intermediates") {
+        const std::int64_t big = std::numeric_limits<std::int64_t>::max();
+        Fraction64 a{big - 1, big};
+        CHECK_EQ(a + Fraction64{1, big}, Fraction64{1, 1});
+        CHECK_LT(Fraction64(big - 2, big), a);
+        CHECK_THROWS_AS(Fraction64(big, 1) + Fraction64(1, 1), std::overflow_error);
+    }
+
+    TEST_CASE("128-bit fractions use checked arithmetic") {
+        const int128_t big = FractionTraits<int128_t>::max();
+        Fraction128 a{big - 1, big};
+        CHECK_EQ(a + Fraction128{1, big}, Fraction128{1, 1});
+        CHECK_EQ(a - a, Fraction128{});
+        CHECK_LT(Fraction128(big - 2, big), a);
+        CHECK_LT(Fraction128(big, big - 1), Fraction128(big - 1, big - 2));
+        CHECK_GT(Fraction128(-big, big - 1), Fraction128(-(big - 1), big - 2));
+        CHECK_THROWS_AS(Fraction128(big, 1) + Fraction128(1, 1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction128(big, 2) * Fraction128(3, 1), std::overflow_error);
+        CHECK_EQ(Fraction128{1, 6} + Fraction128{1, 10}, Fraction128{4, 15});
+    }
+
+    TEST_CASE("128-bit comparison at the limits of the type") {
+        const int128_t lowest = FractionTraits<int128_t>::min();
+        const int128_t big = FractionTraits<int128_t>::max();
+        // The cross products overflow, so these go through the continued fraction expansion
+        CHECK_LT(Fraction128(lowest, 3), Fraction128(lowest + 1, 3));
+        CHECK_LT(Fraction128(-big, big - 1), Fraction128(lowest, big));
+        CHECK_GT(Fraction128(lowest, big), Fraction128(lowest, big - 2));
+        CHECK_LT(Fraction128(lowest, 3), Fraction128(big, 2));
+        CHECK_GT(Fraction128(big, 3), Fraction128(lowest, 5));
+        CHECK_LT(Fraction128(big - 1, big), Fraction128(big, big - 1));
+        CHECK_LT(Fraction128(lowest, big - 1), Fraction128(lowest + 2, big - 1));
+        CHECK_EQ(Fraction128(lowest, 3) <=> Fraction128(lowest, 3), std::strong_ordering::equal);
+        CHECK_EQ(Fraction128(big, 7) <=> Fraction128(big, 7), std::strong_ordering::equal);
+    }
+
+    TEST_CASE("Stream operators for every width") {
+        std::stringstream stream;
+        Fraction8 tiny{-3, 4};
+        stream << tiny;
+        CHECK(stream.str() == "-3/4");
+
+        stream.str("");
+        const int128_t big = FractionTraits<int128_t>::min() + 1;
+        stream << Fraction128{big, 3};
+        CHECK(stream.str() == "-170141183460469231731687303715884105727/3");
+
+        std::stringstream input("-170141183460469231731687303715884105727 3 300 1");
+        Fraction128 read;
+        input >> read;
+        CHECK_EQ(read, Fraction128{big, 3});
+        Fraction8 overflowing;
+        CHECK_THROWS_AS(input >> overflowing, std::runtime_error);
+    }
+}
+
+TEST_SUITE("BigInteger") {
+
+    TEST_CASE("Values that fit in 64 bits stay inline") {
+        BigInteger a{std::numeric_limits<std::int64_t>::max()};
+        CHECK(a.isSmall());
+        BigInteger b = a + BigInteger(1);
+        CHECK_FALSE(b.isSmall());
+        CHECK(b.toString() == "9223372036854775808");
+        CHECK((b - BigInteger(1)).isSmall());
+        CHECK_EQ(b - BigInteger(1), a);
+        CHECK((-b).isSmall());
+        CHECK_EQ(-b, BigInteger(std::numeric_limits<std::int64_t>::min()));
+    }
+
+    TEST_CASE("Multi limb arithmetic") {
+        BigInteger two_to_100 = BigInteger::fromString("1267650600228229401496703205376");
+        BigInteger product = BigInteger(int128_t{1} << 50) * BigInteger(int128_t{1} << 50);
+        CHECK_EQ(product, two_to_100);
+
+        BigInteger remainder;
+        BigInteger quotient = (two_to_100 + BigInteger(12345)).divide(BigInteger(98765), remainder);
+        CHECK(quotient.toString() == "12835018480516674950607028");
+        CHECK_EQ(remainder, BigInteger(97301));
+
+        BigInteger dividend = BigInteger::fromString("10000000000000000000000000000000000000007");
+        BigInteger divisor = BigInteger::fromString("100000000000000000003");
+        CHECK((dividend / divisor).toString() == "99999999999999999997");
+        CHECK_EQ(dividend % divisor, BigInteger(16));
+        CHECK_EQ(-dividend % divisor, BigInteger(-16));
+        CHECK_LT(-dividend, divisor);
+        CHECK_GT(dividend, divisor);
+
+        CHECK_EQ(BigInteger::gcd(two_to_100, BigInteger(int128_t{3} << 70)), BigInteger(int128_t{1} << 70));
+        CHECK_EQ(BigInteger::fromDouble(1e30).toDouble(), 1e30);
+    }
+}
+
+TEST_SUITE("BigFraction") {
+
+    TEST_CASE("Same operators as Fraction") {
+        BigFraction a{1, 3};
+        BigFraction b{-1, 6};
+        CHECK_EQ(a + b, BigFraction(1, 6));
+        CHECK_EQ(a - b, BigFraction(1, 2));
+        CHECK_EQ(a * b, BigFraction(-1, 18));
+        CHECK_EQ(a / b, BigFraction(-2, 1));
+        CHECK_EQ(0.5 + a, BigFraction(5, 6));
+        CHECK_LT(b, a);
+        CHECK_GT(0.5, a);
+        CHECK_EQ(a, 0.333);
+        CHECK_EQ(++a, BigFraction(4, 3));
+        CHECK_EQ(a--, BigFraction(4, 3));
+        CHECK_EQ(a, BigFraction(1, 3));
+        CHECK_THROWS_AS(BigFraction(1, 0), std::invalid_argument);
+        CHECK_THROWS_AS(a / BigFraction(), std::runtime_error);
+
+        std::stringstream stream("7 -21");
+        BigFraction read;
+        stream >> read;
+        CHECK_EQ(read, BigFraction(-1, 3));
+        std::stringstream output;
+        output << read;
+        CHECK(output.str() == "-1/3");
+    }
+
+    TEST_CASE("Stream input reads the output format") {
+        BigFraction big(BigInteger::fromString("-123456789012345678901234567890"), BigInteger(7));
+        std::stringstream stream;
+        stream << big << ' ' << BigFraction(5, 6);
+        BigFraction first;
+        BigFraction second;
+        stream >> first >> second;
+        CHECK_EQ(first, big);
+        CHECK_EQ(second, BigFraction(5, 6));
+
+        std::stringstream mixed("3/-6 4 8");
+        mixed >> first >> second;
+        CHECK_EQ(first, BigFraction(-1, 2));
+        CHECK_EQ(second, BigFraction(1, 2));
+
+        for (const char *text: {"1/", "/2", "1/x", "1/2/3"}) {
+            std::stringstream invalid(text);
+            CHECK_THROWS_AS(invalid >> first, std::runtime_error);
+        }
+        std::stringstream zero("1/0");
+        CHECK_THROWS_AS(zero >> first, std::runtime_error);
+        CHECK_EQ(first, BigFraction(-1, 2));
+    }
+
+    TEST_CASE("Long sums that overflow Fraction finish exactly") {
+        BigFraction sum;
+        for (int k = 1; k <= 100; k++) {
+            sum += BigFraction(1, k);
+        }
+        CHECK_FALSE(sum.isInline());
+        CHECK(sum.getNumerator().toString() == "14466636279520351160221518043104131447711");
+        CHECK(sum.getDenominator().toString() == "2788815009188499086581352357412492142272");
+
+        // Shrinks back to inline storage once the value fits again
+        BigFraction difference = sum - sum + BigFraction(1, 2);
+        CHECK(difference.isInline());
+        CHECK_EQ(difference, BigFraction(1, 2));
+    }
+
+    TEST_CASE("Lossless conversion to and from Fraction") {
+        int max_int = std::numeric_limits<int>::max();
+        Fraction a{max_int - 1, max_int};
+        BigFraction big = a;
+        CHECK(big.isInline());
+        CHECK_EQ(big.toFraction(), a);
+        CHECK_EQ(BigFraction(Fraction64{-5, 10}).toFraction<std::int64_t>(), Fraction64{-1, 2});
+        CHECK_THROWS_AS((big + big).toFraction(), std::overflow_error);
+        CHECK_EQ((big + big).toFraction<std::int64_t>(), Fraction64{2 * (std::int64_t{max_int} - 1), max_int});
+        // Terms wider than 128 bits never convert, whichever width is asked for
+        BigInteger wide = BigInteger(int128_t{1} << 100) * (int128_t{1} << 100);
+        CHECK_THROWS_AS((void) BigFraction(wide, 3).toFraction<std::int64_t>(), std::overflow_error);
+        CHECK_THROWS_AS((void) BigFraction(1, wide + 1).toFraction<std::int64_t>(), std::overflow_error);
+    }
+}
+
+TEST_SUITE("Gcd kernels") {
+
+    TEST_CASE("Binary and Lehmer gcd agree with Euclid") {
+        std::mt19937_64 engine(7);
+        for (int i = 0; i < 1000; i++) {
+            std::uint64_t a = engine();
+            std::uint64_t b = engine() >> (i % 64);
+            uint128_t wide_a = (static_cast<uint128_t>(engine()) << 64U) | engine();
+            uint128_t wide_b = ((static_cast<uint128_t>(engine()) << 64U) | engine()) >> (i % 128);
+            // Give the pairs a large common factor every other round
+            if (i % 2 == 0) {
+                b = (b >> 32U) * (a >> 40U);
+                wide_b = (wide_b >> 64U) * (wide_a >> 80U);
+            }
+            CHECK_EQ(binaryGcd(static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b)),
+                     euclidGcd(static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b)));
+            CHECK_EQ(binaryGcd(a, b), euclidGcd(a, b));
+            CHECK(lehmerGcd(wide_a, wide_b) == euclidGcd(wide_a, wide_b));
+            CHECK(binaryGcd(wide_a, wide_b) == euclidGcd(wide_a, wide_b));
+        }
+        CHECK_EQ(binaryGcd(0U, 12U), 12U);
+        CHECK_EQ(binaryGcd(12U, 0U), 12U);
+        CHECK(lehmerGcd(uint128_t{1} << 100U, 0) == uint128_t{1} << 100U);
+    }
+
+    TEST_CASE("Consecutive Fibonacci numbers are coprime") {
+        uint128_t previous = 1;
+        uint128_t current = 1;
+        BigInteger big_previous = 1;
+        BigInteger big_current = 1;
+        for (int i = 0; i < 300; i++) {
+            uint128_t next = previous + current;
+            previous = current;
+            current = next;
+            BigInteger big_next = big_previous + big_current;
+            big_previous = big_current;
+            big_current = big_next;
+            if (i < 180) {
+                CHECK(lehmerGcd(current, previous) == 1);
+            }
+        }
+        CHECK_EQ(BigInteger::gcd(big_current, big_previous), BigInteger(1));
+        CHECK_EQ(BigInteger::gcd(big_current * BigInteger(1000003), big_previous * BigInteger(1000003)),
+                 BigInteger(1000003));
+    }
+
+    TEST_CASE("The constructor reduces with a single gcd") {
+        Fraction a{-48, -180};
+        CHECK_EQ(a.getNumerator(), 4);
+        CHECK_EQ(a.getDenominator(), 15);
+        Fraction64 b{std::int64_t{1} << 62, -(std::int64_t{1} << 40)};
+        CHECK_EQ(b.getNumerator(), -(std::int64_t{1} << 22));
+        CHECK_EQ(b.getDenominator(), 1);
+    }
+}
+
+TEST_SUITE("Cross-reduction in multiplication and division") {
+
+    TEST_CASE("Products that reduce to small values do not throw") {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        CHECK_EQ(Fraction(max_int, 3) * Fraction(3, max_int), Fraction(1, 1));
+        CHECK_EQ(Fraction(max_int, 2) / Fraction(max_int, 4), Fraction(2, 1));
+        CHECK_EQ(Fraction(min_int, 1) * Fraction(1, 2), Fraction(min_int / 2, 1));
+        CHECK_EQ(Fraction(min_int, 1) / Fraction(min_int, 1), Fraction(1, 1));
+        CHECK_EQ(Fraction(3, 7) / Fraction(-9, 14), Fraction(-2, 3));
+        CHECK_EQ(Fraction(0, 1) / Fraction(-9, 14), Fraction(0, 1));
+        CHECK_EQ(Fraction128(FractionTraits<int128_t>::max(), 5) * Fraction128(10, FractionTraits<int128_t>::max()),
+                 Fraction128(2, 1));
+    }
+
+    TEST_CASE("Results that do not fit still throw") {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        CHECK_THROWS_AS(Fraction(max_int, 2) * Fraction(3, 1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction(1, max_int) / Fraction(3, 1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction(min_int, 1) / Fraction(-1, 1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction(1, 1) / Fraction(min_int, 1), std::overflow_error);
+        CHECK_EQ(Fraction(-1, 1) / Fraction(min_int + 1, 1), Fraction(1, max_int));
+    }
+}
+
+TEST_SUITE("Conversion from floating point") {
+
+    TEST_CASE("from_double finds the best approximation") {
+        CHECK_EQ(Fraction::from_double(0.3333), Fraction(3333, 10000));
+        CHECK_EQ(Fraction::from_double(0.1), Fraction(1, 10));
+        CHECK_EQ(Fraction::from_double(-0.75), Fraction(-3, 4));
+        CHECK_EQ(Fraction::from_double(0.0), Fraction(0, 1));
+        CHECK_EQ(Fraction::from_double(3.141592653589793, 1000), Fraction(355, 113));
+        CHECK_EQ(Fraction::from_double(3.141592653589793, 100), Fraction(311, 99));
+        CHECK_EQ(Fraction::from_double(-3.141592653589793, 7), Fraction(-22, 7));
+        CHECK_EQ(Fraction::from_double(0.001, 100), Fraction(0, 1));
+        CHECK_EQ(Fraction::from_double(1e-300), Fraction(0, 1));
+        CHECK_EQ(Fraction64::from_double(1e10), Fraction64(10000000000, 1));
+        CHECK_EQ(Fraction::from_double(2147483647.0), Fraction(2147483647, 1));
+    }
+
+    TEST_CASE("from_double is never worse than any fraction with a smaller denominator") {
+        std::mt19937_64 generator(8);
+        std::uniform_real_distribution<double> values(-10.0, 10.0);
+        std::uniform_int_distribution<int> bounds(1, 60);
+        for (int i = 0; i < 500; i++) {
+            double value = values(generator);
+            int bound = bounds(generator);
+            Fraction best = Fraction::from_double(value, bound);
+            CHECK(best.getDenominator() <= bound);
+            long double error = std::abs(static_cast<long double>(best.getNumerator()) / best.getDenominator() - value);
+            for (int denominator = 1; denominator <= bound; denominator++) {
+                auto numerator = static_cast<long double>(std::lround(value * denominator));
+                CHECK(error <= std::abs(numerator / denominator - value));
+            }
+        }
+    }
+
+    TEST_CASE("from_float returns the simplest fraction that rounds to the float") {
+        CHECK_EQ(Fraction::from_float(0.1F), Fraction(1, 10));
+        CHECK_EQ(Fraction::from_float(0.333F), Fraction(333, 1000));
+        // A float only has 24 significant bits, 3331/9994 rounds to the same float as 0.3333
+        CHECK_EQ(Fraction::from_float(0.3333F), Fraction(3331, 9994));
+        CHECK_EQ(Fraction::from_float(1.0F / 3), Fraction(1, 3));
+        CHECK_EQ(Fraction::from_float(-2.625F), Fraction(-21, 8));
+        CHECK_EQ(Fraction::from_float(16777216.0F), Fraction(16777216, 1));
+        CHECK_EQ(Fraction::from_float(0.1F, 5), Fraction(1, 5));
+        CHECK_EQ(Fraction::from_float(0.0F), Fraction(0, 1));
+        for (int i = -2000; i <= 2000; i++) {
+            CHECK_EQ(Fraction::from_float(static_cast<float>(i) / 1000), Fraction(i, 1000));
+        }
+    }
+
+    TEST_CASE("from_double_exact decodes the binary value") {
+        CHECK_EQ(Fraction::from_double_exact(-2.5), Fraction(-5, 2));
+        CHECK_EQ(Fraction::from_double_exact(0.0), Fraction(0, 1));
+        CHECK_EQ(Fraction::from_double_exact(0.5F), Fraction(1, 2));
+        CHECK_EQ(Fraction64::from_double_exact(0.1), Fraction64(3602879701896397, 36028797018963968));
+        CHECK_EQ(Fraction128::from_double_exact(0x1p-125), Fraction128(1, int128_t{1} << 125));
+        CHECK_THROWS_AS(Fraction::from_double_exact(0.1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction::from_double_exact(0x1p31), std::overflow_error);
+        CHECK_THROWS_AS(Fraction128::from_double_exact(0x1p-127), std::overflow_error);
+    }
+
+    TEST_CASE("Invalid input throws") {
+        CHECK_THROWS_AS(Fraction::from_double(std::numeric_limits<double>::quiet_NaN()), std::invalid_argument);
+        CHECK_THROWS_AS(Fraction::from_double(std::numeric_limits<double>::infinity()), std::invalid_argument);
+        CHECK_THROWS_AS(Fraction::from_float(-std::numeric_limits<float>::infinity()), std::invalid_argument);
+        CHECK_THROWS_AS(Fraction::from_double(0.5, 0), std::invalid_argument);
+        CHECK_THROWS_AS(Fraction::from_double(1e10), std::overflow_error);
+        CHECK_THROWS_AS(Fraction::from_double(1e300), std::overflow_error);
+        CHECK_THROWS_AS(Fraction8::from_float(200.5F), std::overflow_error);
+    }
+}
+
+TEST_SUITE("Text conversion") {
+
+    // Formats a fraction with to_chars into a string
+    template<typename IntT>
+    std::string format(const BasicFraction<IntT> &fraction) {
+        char text[BasicFraction<IntT>::MAX_CHARS];
+        std::to_chars_result result = ariel::to_chars(text, text + sizeof(text), fraction);
+        CHECK(result.ec == std::errc{});
+        return std::string(text, result.ptr);
+    }
+
+    // Parses a whole string with from_chars
+    template<typename IntT>
+    std::errc parse(const std::string &text, BasicFraction<IntT> &fraction) {
+        std::from_chars_result result = ariel::from_chars(text.data(), text.data() + text.size(), fraction);
+        if (result.ec == std::errc{}) {
+            CHECK(result.ptr == text.data() + text.size());
+        }
+        return result.ec;
+    }
+
+    TEST_CASE("to_chars writes numerator/denominator") {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        CHECK(format(Fraction{3, -4}) == "-3/4");
+        CHECK(format(Fraction{}) == "0/1");
+        CHECK(format(Fraction{min_int, max_int}) == "-2147483648/2147483647");
+        CHECK(format(Fraction8{-128, 127}) == "-128/127");
+        CHECK(format(Fraction64{std::numeric_limits<std::int64_t>::min(), 1}) == "-9223372036854775808/1");
+        CHECK(format(Fraction128{FractionTraits<int128_t>::min(), 3}) ==
+              "-170141183460469231731687303715884105728/3");
+
+        char small[4];
+        std::to_chars_result result = ariel::to_chars(small, small + sizeof(small), Fraction{123, 4});
+        CHECK(result.ec == std::errc::value_too_large);
+        CHECK(result.ptr == small + sizeof(small));
+        result = ariel::to_chars(small, small + sizeof(small), Fraction{12, 5});
+        CHECK(result.ec == std::errc{});
+        CHECK(std::string(small, result.ptr) == "12/5");
+    }
+
+    TEST_CASE("from_chars accepts both syntaxes") {
+        Fraction fraction;
+        CHECK(parse("6/8", fraction) == std::errc{});
+        CHECK_EQ(fraction, Fraction(3, 4));
+        CHECK(parse("-6 \t 8", fraction) == std::errc{});
+        CHECK_EQ(fraction, Fraction(-3, 4));
+        CHECK(parse("5/-10", fraction) == std::errc{});
+        CHECK_EQ(fraction, Fraction(-1, 2));
+        CHECK(parse("-2147483648/1", fraction) == std::errc{});
+        CHECK_EQ(fraction.getNumerator(), std::numeric_limits<int>::min());
+        CHECK(parse("2 -2147483648", fraction) == std::errc{});
+        CHECK_EQ(fraction, Fraction(-1, 1 << 30));
+        CHECK(parse("4294967296/4294967296", fraction) == std::errc{});
+        CHECK_EQ(fraction, Fraction(1, 1));
+
+        Fraction128 wide;
+        CHECK(parse("-170141183460469231731687303715884105728/2", wide) == std::errc{});
+        CHECK_EQ(wide, Fraction128(-(int128_t{1} << 126), 1));
+
+        // Parsing stops after the denominator
+        std::string text = "1/2, 3/4";
+        std::from_chars_result result = ariel::from_chars(text.data(), text.data() + text.size(), fraction);
+        CHECK(result.ec == std::errc{});
+        CHECK(result.ptr == text.data() + 3);
+        CHECK_EQ(fraction, Fraction(1, 2));
+    }
+
+    TEST_CASE("from_chars reports errors without throwing") {
+        Fraction fraction{1, 3};
+        CHECK(parse("", fraction) == std::errc::invalid_argument);
+        CHECK(parse("7", fraction) == std::errc::invalid_argument);
+        CHECK(parse("3.5 4", fraction) == std::errc::invalid_argument);
+        CHECK(parse("+3/4", fraction) == std::errc::invalid_argument);
+        CHECK(parse("3/ 4", fraction) == std::errc::invalid_argument);
+        CHECK(parse(" 3/4", fraction) == std::errc::invalid_argument);
+        CHECK(parse("3/0", fraction) == std::errc::argument_out_of_domain);
+        CHECK(parse("2147483648/1", fraction) == std::errc::result_out_of_range);
+        CHECK(parse("1 -2147483648", fraction) == std::errc::result_out_of_range);
+        CHECK(parse("99999999999999999999/1", fraction) == std::errc::result_out_of_range);
+        Fraction128 wide;
+        CHECK(parse("170141183460469231731687303715884105728/1", wide) == std::errc::result_out_of_range);
+        CHECK(parse("1701411834604692317316873037158841057280000/1", wide) == std::errc::result_out_of_range);
+        // The value is untouched by a failed parse
+        CHECK_EQ(fraction, Fraction(1, 3));
+
+        std::string text = "x";
+        std::from_chars_result result = ariel::from_chars(text.data(), text.data() + text.size(), fraction);
+        CHECK(result.ptr == text.data());
+    }
+
+    TEST_CASE("Stream operators round trip through the text conversion") {
+        std::stringstream stream("3/4 -5 10\n7/-14\t9 3");
+        Fraction a, b, c, d;
+        stream >> a >> b >> c >> d;
+        CHECK_EQ(a, Fraction(3, 4));
+        CHECK_EQ(b, Fraction(-1, 2));
+        CHECK_EQ(c, Fraction(-1, 2));
+        CHECK_EQ(d, Fraction(3, 1));
+
+        std::mt19937 engine(9);
+        std::uniform_int_distribution<int> values(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+        std::stringstream round_trip;
+        std::vector<Fraction> written;
+        for (int i = 0; i < 1000; i++) {
+            int denominator = values(engine);
+            written.emplace_back(values(engine), denominator == 0 || denominator == std::numeric_limits<int>::min()
+                                                 ? 1 : denominator);
+            round_trip << written.back() << (i % 2 == 0 ? " " : "\n");
+        }
+        for (const Fraction &expected: written) {
+            Fraction read;
+            round_trip >> read;
+            CHECK_EQ(read, expected);
+        }
+
+        std::stringstream bad("1/2 3/x");
+        CHECK_NOTHROW(bad >> a);
+        CHECK_THROWS_AS(bad >> a, std::runtime_error);
+        CHECK(bad.fail());
+        std::stringstream zero("1/0");
+        CHECK_THROWS_WITH_AS(zero >> a, "Division by Zero", std::runtime_error);
+        std::stringstream too_long(std::string(200, '1'));
+        CHECK_THROWS_AS(too_long >> a, std::runtime_error);
+    }
+}
+
+TEST_SUITE("FractionVector") {
+
+    // Random non zero fractions with terms below the given bound
+    std::vector<Fraction> randomFractionsForVector(std::size_t count, int bound, unsigned seed) {
+        std::mt19937 engine(seed);
+        std::uniform_int_distribution<int> numerators(-bound, bound);
+        std::uniform_int_distribution<int> denominators(1, bound);
+        std::vector<Fraction> result;
+        for (std::size_t i = 0; i < count; i++) {
+            int numerator = numerators(engine);
+            result.emplace_back(numerator == 0 ? 1 : numerator, denominators(engine));
+        }
+        return result;
+    }
+
+    // Every instruction set the processor supports
+    std::vector<FractionVector::SimdLevel> supportedLevels() {
+        std::vector<FractionVector::SimdLevel> levels{FractionVector::SimdLevel::Scalar};
+        if (FractionVector::supportedSimdLevel() >= FractionVector::SimdLevel::Sse4) {
+            levels.push_back(FractionVector::SimdLevel::Sse4);
+        }
+        if (FractionVector::supportedSimdLevel() >= FractionVector::SimdLevel::Avx2) {
+            levels.push_back(FractionVector::SimdLevel::Avx2);
+        }
+        return levels;
+    }
+
+    // Random fractions mixing small values and values near the int limits
+    std::vector<Fraction> mixedFractions(std::size_t count, unsigned seed) {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        std::mt19937 engine(seed);
+        std::uniform_int_distribution<int> small(-12, 12);
+        std::uniform_int_distribution<int> large(min_int, max_int);
+        std::vector<Fraction> result;
+        for (std::size_t i = 0; i < count; i++) {
+            int numerator = i % 3 == 0 ? large(engine) : small(engine);
+            int denominator = i % 5 == 0 ? large(engine) : small(engine);
+            if (denominator == 0 || denominator == min_int) {
+                denominator = 1;
+            }
+            result.emplace_back(numerator, denominator);
+        }
+        result[1] = Fraction(min_int, 1);
+        result[2] = Fraction(max_int, 1);
+        return result;
+    }
+
+    // Returns true if the Fraction operator throws
+    template<typename Operation>
+    bool throws(Operation operation) {
+        try {
+            operation();
+            return false;
+        } catch (const std::exception &) {
+            return true;
+        }
+    }
+
+    TEST_CASE("Batch operations match the Fraction operators near the int limits") {
+        const FractionVector::SimdLevel original = FractionVector::simdLevel();
+        const std::size_t count = 2000;
+        const std::size_t block = 16;
+        const std::size_t position = 5;
+        std::vector<Fraction> lhs = mixedFractions(count, 10);
+        std::vector<Fraction> rhs = mixedFractions(count, 11);
+        rhs[7] = Fraction(0, 1);
+        // Pairs on which no operator throws form full vectors, every other pair is placed inside a block of those
+        FractionVector safe_lhs;
+        FractionVector safe_rhs;
+        std::vector<std::size_t> safe;
+        std::vector<std::size_t> failing;
+        for (std::size_t i = 0; i < count; i++) {
+            if (throws([&] { return lhs[i] + rhs[i]; }) || throws([&] { return lhs[i] - rhs[i]; }) ||
+                throws([&] { return lhs[i] * rhs[i]; }) || throws([&] { return lhs[i] / rhs[i]; })) {
+                failing.push_back(i);
+            } else {
+                safe.push_back(i);
+                safe_lhs.push_back(lhs[i]);
+                safe_rhs.push_back(rhs[i]);
+            }
+        }
+        REQUIRE(safe.size() > block);
+        REQUIRE(!failing.empty());
+        for (FractionVector::SimdLevel level: supportedLevels()) {
+            FractionVector::setSimdLevel(level);
+            FractionVector sum = safe_lhs.add(safe_rhs);
+            FractionVector difference = safe_lhs.sub(safe_rhs);
+            FractionVector product = safe_lhs.mul(safe_rhs);
+            FractionVector quotient = safe_lhs.div(safe_rhs);
+            for (std::size_t k = 0; k < safe.size(); k++) {
+                std::size_t i = safe[k];
+                CHECK_EQ(sum[k], lhs[i] + rhs[i]);
+                CHECK_EQ(difference[k], lhs[i] - rhs[i]);
+                CHECK_EQ(product[k], lhs[i] * rhs[i]);
+                CHECK_EQ(quotient[k], lhs[i] / rhs[i]);
+            }
+            for (std::size_t i: failing) {
+                FractionVector left;
+                FractionVector right;
+                for (std::size_t k = 0; k < block; k++) {
+                    left.push_back(k == position ? lhs[i] : safe_lhs[k]);
+                    right.push_back(k == position ? rhs[i] : safe_rhs[k]);
+                }
+                CHECK_EQ(throws([&] { return left.add(right); }), throws([&] { return lhs[i] + rhs[i]; }));
+                CHECK_EQ(throws([&] { return left.sub(right); }), throws([&] { return lhs[i] - rhs[i]; }));
+                CHECK_EQ(throws([&] { return left.mul(right); }), throws([&] { return lhs[i] * rhs[i]; }));
+                if (rhs[i] == Fraction(0, 1)) {
+                    CHECK_THROWS_AS(left.div(right), std::runtime_error);
+                } else {
+                    CHECK_EQ(throws([&] { return left.div(right); }), throws([&] { return lhs[i] / rhs[i]; }));
+                }
+            }
+        }
+        FractionVector::setSimdLevel(original);
+    }
+
+    TEST_CASE("Whole vectors agree across instruction sets") {
+        const FractionVector::SimdLevel original = FractionVector::simdLevel();
+        const std::size_t count = 1003;
+        std::vector<Fraction> lhs = randomFractionsForVector(count, 1 << 15, 12);
+        std::vector<Fraction> rhs = randomFractionsForVector(count, 1 << 15, 13);
+        FractionVector left(lhs);
+        FractionVector right(rhs);
+        for (FractionVector::SimdLevel level: supportedLevels()) {
+            FractionVector::setSimdLevel(level);
+            CHECK_EQ(FractionVector::simdLevel(), level);
+            FractionVector sum = left.add(right);
+            FractionVector difference = left.sub(right);
+            FractionVector product = left.mul(right);
+            FractionVector quotient = left.div(right);
+            std::vector<int> order = left.compare(right);
+            REQUIRE_EQ(sum.size(), count);
+            REQUIRE_EQ(order.size(), count);
+            for (std::size_t i = 0; i < count; i++) {
+                CHECK_EQ(sum[i], lhs[i] + rhs[i]);
+                CHECK_EQ(difference[i], lhs[i] - rhs[i]);
+                CHECK_EQ(product[i], lhs[i] * rhs[i]);
+                CHECK_EQ(quotient[i], lhs[i] / rhs[i]);
+                CHECK_EQ(order[i], lhs[i] < rhs[i] ? -1 : (lhs[i] == rhs[i] ? 0 : 1));
+                // The stored values are already reduced with a positive denominator
+                CHECK_EQ(sum.numerators()[i], sum[i].getNumerator());
+                CHECK_EQ(sum.denominators()[i], sum[i].getDenominator());
+            }
+            CHECK_EQ(left.compare(left), std::vector<int>(count, 0));
+        }
+        FractionVector::setSimdLevel(original);
+    }
+
+    TEST_CASE("reduce normalizes raw values") {
+        const FractionVector::SimdLevel original = FractionVector::simdLevel();
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        for (FractionVector::SimdLevel level: supportedLevels()) {
+            FractionVector::setSimdLevel(level);
+            const std::size_t count = 21;
+            FractionVector vector(count);
+            for (std::size_t i = 0; i < count; i++) {
+                auto value = static_cast<int>(i);
+                vector.numerators()[i] = (value - 10) * 6;
+                vector.denominators()[i] = value % 2 == 0 ? -4 * value - 4 : 9;
+            }
+            vector.numerators()[20] = min_int;
+            vector.denominators()[20] = min_int;
+            vector.reduce();
+            for (std::size_t i = 0; i < count - 1; i++) {
+                auto value = static_cast<int>(i);
+                Fraction expected_value((value - 10) * 6, value % 2 == 0 ? -4 * value - 4 : 9);
+                CHECK_EQ(vector.numerators()[i], expected_value.getNumerator());
+                CHECK_EQ(vector.denominators()[i], expected_value.getDenominator());
+            }
+            CHECK_EQ(vector[20], Fraction(1, 1));
+
+            FractionVector zero(count);
+            zero.denominators()[13] = 0;
+            CHECK_THROWS_AS(zero.reduce(), std::invalid_argument);
+            FractionVector negative(count);
+            negative.numerators()[3] = 1;
+            negative.denominators()[3] = min_int;
+            CHECK_THROWS_AS(negative.reduce(), std::overflow_error);
+            negative.numerators()[3] = max_int;
+            negative.denominators()[3] = -1;
+            negative.reduce();
+            CHECK_EQ(negative[3], Fraction(-max_int, 1));
+        }
+        FractionVector::setSimdLevel(original);
+    }
+
+    TEST_CASE("Container basics") {
+        FractionVector vector{Fraction(1, 2), Fraction(-3, 4)};
+        CHECK_EQ(vector.size(), 2);
+        vector.push_back(Fraction(5, 6));
+        vector.set(0, Fraction(7, 8));
+        CHECK_EQ(vector[0], Fraction(7, 8));
+        CHECK_EQ(vector[2], Fraction(5, 6));
+        vector.resize(4);
+        CHECK_EQ(vector[3], Fraction(0, 1));
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(vector.numerators()) % FractionVector::ALIGNMENT, 0);
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(vector.denominators()) % FractionVector::ALIGNMENT, 0);
+        CHECK_THROWS_AS(vector.add(FractionVector(3)), std::invalid_argument);
+        vector.clear();
+        CHECK(vector.empty());
+        CHECK(vector.add(FractionVector()).empty());
+    }
+}
+
+TEST_SUITE("Constant expressions") {
+
+    // Evaluated by the compiler, a failure stops the build
+    constexpr Fraction SUM = Fraction(1, 3) + Fraction(1, 6);
+    static_assert(SUM == Fraction(1, 2));
+    static_assert(SUM.getNumerator() == 1 && SUM.getDenominator() == 2);
+    static_assert(Fraction(6, -4).getNumerator() == -3 && Fraction(6, -4).getDenominator() == 2);
+    static_assert(Fraction(1, 2) - Fraction(3, 4) == Fraction(-1, 4));
+    static_assert(Fraction(2, 3) * Fraction(9, 4) == Fraction(3, 2));
+    static_assert(Fraction(2, 3) / Fraction(-4, 9) == Fraction(-3, 2));
+    static_assert(Fraction(1, 3) < Fraction(1, 2) && Fraction(-1, 2) <= Fraction(-1, 2));
+    static_assert((Fraction(7, 5) <=> Fraction(7, 5)) == 0);
+    static_assert(Fraction{} == Fraction(0, 5));
+
+    constexpr Fraction incremented() {
+        Fraction value(1, 4);
+        ++value;
+        value++;
+        --value;
+        return value;
+    }
+    static_assert(incremented() == Fraction(5, 4));
+
+    constexpr Fraction simplified() {
+        Fraction value(1, 1);
+        value = value / Fraction(12, 1) * Fraction(8, 1);
+        value.simplify();
+        return value;
+    }
+    static_assert(simplified() == Fraction(2, 3));
+
+    // The other widths, including the checked 128-bit paths
+    static_assert(Fraction8(100, 3) + Fraction8(1, 3) == Fraction8(101, 3));
+    static_assert(Fraction64(1, 3) + Fraction64(1, 6) == Fraction64(1, 2));
+    static_assert(Fraction128(1, 3) + Fraction128(1, 6) == Fraction128(1, 2));
+    static_assert(Fraction128(2, 3) * Fraction128(3, 2) == Fraction128(1, 1));
+    static_assert(Fraction128(FractionTraits<int128_t>::max(), 2) > Fraction128(FractionTraits<int128_t>::max() - 1, 2));
+
+    // True if calling the captureless lambda is a constant expression. Throwing is not, so invalid
+    // arguments and overflow are detected at compile time too.
+    template<typename Operation, bool = (Operation{}(), true)>
+    constexpr bool foldsAtCompileTime(Operation) {
+        return true;
+    }
+
+    constexpr bool foldsAtCompileTime(...) {
+        return false;
+    }
+
+    TEST_CASE("Fraction arithmetic folds at compile time") {
+        // The static_asserts above are the actual test, these values are only checked again at run time
+        CHECK_EQ(SUM, Fraction(1, 2));
+        CHECK(foldsAtCompileTime([] { return Fraction(1, 3) + Fraction(1, 6); }));
+        CHECK_FALSE(foldsAtCompileTime([] { return Fraction(1, 0); }));
+        CHECK_FALSE(foldsAtCompileTime([] { return Fraction(std::numeric_limits<int>::max(), 1) + Fraction(1, 1); }));
+    }
+}
+
+TEST_SUITE("Checked arithmetic") {
+
+    static_assert(checked_add(Fraction(1, 3), Fraction(1, 6)).value() == Fraction(1, 2));
+    static_assert(checked_div(Fraction(1, 3), Fraction()).error() == FractionError::DivisionByZero);
+    static_assert(!Fraction::try_make(1, 0));
+
+    TEST_CASE("try_make reports errors instead of throwing") {
+        int min_int = std::numeric_limits<int>::min();
+        CheckedResult<Fraction> made = Fraction::try_make(6, -4);
+        REQUIRE(made.has_value());
+        CHECK_EQ(*made, Fraction(-3, 2));
+        CHECK_EQ(made->getDenominator(), 2);
+        CHECK_EQ(Fraction::try_make(3, 0).error(), FractionError::ZeroDenominator);
+        // The minimum value has no positive counterpart, so the sign can't move to the numerator
+        CHECK_EQ(Fraction::try_make(min_int, -1).error(), FractionError::Overflow);
+        CHECK_EQ(Fraction::try_make(1, min_int).error(), FractionError::Overflow);
+        CHECK_EQ(*Fraction::try_make(min_int, min_int), Fraction(1, 1));
+        CHECK_EQ(*Fraction::try_make(2, min_int), Fraction(-1, 1 << 30));
+        CHECK_THROWS_AS(Fraction(min_int, -1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction(1, 0), std::invalid_argument);
+    }
+
+    TEST_CASE("Result accessors") {
+        CheckedResult<Fraction> failed = checked_mul(Fraction(std::numeric_limits<int>::max(), 1), Fraction(2, 1));
+        CHECK_FALSE(failed);
+        CHECK_EQ(failed.error(), FractionError::Overflow);
+        CHECK_EQ(failed.value_or(Fraction(7, 1)), Fraction(7, 1));
+        CHECK_THROWS_AS(failed.value(), std::overflow_error);
+        CHECK_THROWS_AS(checked_div(Fraction(1, 2), Fraction()).value(), std::runtime_error);
+        CHECK_EQ(checked_sub(Fraction(1, 2), Fraction(1, 3)).value(), Fraction(1, 6));
+        CHECK_EQ(checked_sub(Fraction(1, 2), Fraction(1, 3)).error(), FractionError::None);
+    }
+
+    // The error the operator reports by throwing
+    template<typename Operation>
+    FractionError thrownError(Operation operation) {
+        try {
+            operation();
+            return FractionError::None;
+        } catch (const std::overflow_error &) {
+            return FractionError::Overflow;
+        } catch (const std::invalid_argument &) {
+            return FractionError::ZeroDenominator;
+        } catch (const std::runtime_error &) {
+            return FractionError::DivisionByZero;
+        }
+    }
+
+    template<typename IntT>
+    void checkAgainstOperators(const std::vector<BasicFraction<IntT>> &values) {
+        using FractionT = BasicFraction<IntT>;
+        for (const FractionT &lhs: values) {
+            for (const FractionT &rhs: values) {
+                CheckedResult<FractionT> results[] = {checked_add(lhs, rhs), checked_sub(lhs, rhs),
+                                                      checked_mul(lhs, rhs), checked_div(lhs, rhs)};
+                FractionError errors[] = {thrownError([&] { return lhs + rhs; }), thrownError([&] { return lhs - rhs; }),
+                                          thrownError([&] { return lhs * rhs; }), thrownError([&] { return lhs / rhs; })};
+                CHECK_EQ(results[0].error(), errors[0]);
+                CHECK_EQ(results[1].error(), errors[1]);
+                CHECK_EQ(results[2].error(), errors[2]);
+                CHECK_EQ(results[3].error(), errors[3]);
+                if (results[0]) {
+                    CHECK_EQ(*results[0], lhs + rhs);
+                }
+                if (results[3]) {
+                    CHECK_EQ(*results[3], lhs / rhs);
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Checked operations fail exactly where the operators throw") {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        checkAgainstOperators<int>({Fraction(), Fraction(1, 2), Fraction(-3, 7), Fraction(max_int, 1),
+                                    Fraction(min_int, 1), Fraction(1, max_int), Fraction(-1, max_int),
+                                    Fraction(max_int, max_int - 1), Fraction(min_int, 3)});
+        std::int64_t max64 = std::numeric_limits<std::int64_t>::max();
+        checkAgainstOperators<std::int64_t>({Fraction64(), Fraction64(max64, 1), Fraction64(1, max64),
+                                             Fraction64(-max64, 2), Fraction64(5, 3)});
+        int128_t max128 = FractionTraits<int128_t>::max();
+        checkAgainstOperators<int128_t>({Fraction128(), Fraction128(max128, 1), Fraction128(1, max128),
+                                         Fraction128(-max128, 2), Fraction128(5, 3)});
+    }
+}
+
+TEST_SUITE("Overflow policies") {
+
+    using SaturatingFraction = BasicFraction<int, OverflowPolicy::Saturate>;
+    using PromotingFraction = BasicFraction<int, OverflowPolicy::Promote>;
+    using WrappingFraction = BasicFraction<int, OverflowPolicy::Unchecked>;
+
+    static_assert(std::is_same_v<BasicFraction<int, OverflowPolicy::Throw>, Fraction>);
+    static_assert(std::is_same_v<decltype(PromotingFraction() + PromotingFraction()),
+                                 BasicFraction<std::int64_t, OverflowPolicy::Promote>>);
+    static_assert(std::is_same_v<decltype(SaturatingFraction() * SaturatingFraction()), SaturatingFraction>);
+
+    TEST_CASE("Throw is the default") {
+        int max_int = std::numeric_limits<int>::max();
+        CHECK_THROWS_AS(Fraction(max_int, 1) + Fraction(1, 1), std::overflow_error);
+        CHECK_THROWS_AS(Fraction(1, 2) / Fraction(), std::runtime_error);
+    }
+
+    TEST_CASE("Saturate clamps large values and approximates fine ones") {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        CHECK_EQ(SaturatingFraction(max_int, 1) + SaturatingFraction(1, 1), SaturatingFraction(max_int, 1));
+        CHECK_EQ(SaturatingFraction(min_int, 1) - SaturatingFraction(1, 1), SaturatingFraction(min_int, 1));
+        CHECK_EQ(SaturatingFraction(max_int, 1) * SaturatingFraction(-3, 1), SaturatingFraction(min_int, 1));
+        CHECK_EQ(SaturatingFraction(max_int, 1) / SaturatingFraction(1, 4), SaturatingFraction(max_int, 1));
+        // 2/(3*max) is closer to 1/max than to 0
+        CHECK_EQ(SaturatingFraction(1, max_int) * SaturatingFraction(2, 3), SaturatingFraction(1, max_int));
+        CHECK_EQ(SaturatingFraction(1, max_int) * SaturatingFraction(-1, 3), SaturatingFraction(0, 1));
+        // Results that fit are exact
+        CHECK_EQ(SaturatingFraction(1, 3) + SaturatingFraction(1, 6), SaturatingFraction(1, 2));
+        CHECK_THROWS_AS(SaturatingFraction(1, 2) / SaturatingFraction(), std::runtime_error);
+    }
+
+    TEST_CASE("Saturated results are the closest representable values") {
+        int max_int = std::numeric_limits<int>::max();
+        std::mt19937 engine(11);
+        std::uniform_int_distribution<int> large(-max_int, max_int);
+        std::uniform_int_distribution<int> positive(1, max_int);
+        BigFraction limit(max_int, 1);
+        for (int i = 0; i < 500; i++) {
+            SaturatingFraction lhs(large(engine), positive(engine));
+            SaturatingFraction rhs(large(engine), i % 2 == 0 ? positive(engine) : 1);
+            SaturatingFraction results[] = {lhs + rhs, lhs - rhs, lhs * rhs, lhs / rhs};
+            BigFraction exact[] = {BigFraction(lhs) + BigFraction(rhs), BigFraction(lhs) - BigFraction(rhs),
+                                   BigFraction(lhs) * BigFraction(rhs), BigFraction(lhs) / BigFraction(rhs)};
+            for (int operation = 0; operation < 4; operation++) {
+                BigFraction result(results[operation]);
+                if (exact[operation] > limit) {
+                    CHECK_EQ(results[operation], SaturatingFraction(max_int, 1));
+                } else if (exact[operation] < BigFraction(-max_int - 1, 1)) {
+                    CHECK_EQ(results[operation], SaturatingFraction(-max_int - 1, 1));
+                } else {
+                    // Fractions with denominators up to max are at most 1/max apart below 1, and the
+                    // integers are representable everywhere
+                    bool small = exact[operation] < BigFraction(1, 1) && exact[operation] > BigFraction(-1, 1);
+                    BigFraction bound = small ? BigFraction(1, max_int) : BigFraction(1, 1);
+                    CHECK(result - exact[operation] <= bound);
+                    CHECK(exact[operation] - result <= bound);
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Promote returns exact wider fractions") {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        auto sum = PromotingFraction(max_int, 1) + PromotingFraction(max_int, 1);
+        CHECK_EQ(sum, BasicFraction<std::int64_t, OverflowPolicy::Promote>(2LL * max_int, 1));
+        auto product = PromotingFraction(min_int, 1) * PromotingFraction(min_int, 1);
+        CHECK_EQ(product.getNumerator(), std::int64_t{1} << 62);
+        auto quotient = PromotingFraction(1, max_int) / PromotingFraction(max_int, 1);
+        CHECK_EQ(quotient.getDenominator(), std::int64_t{max_int} * max_int);
+        // 64-bit values promote to 128 bits, which have no wider type and throw
+        auto wide = product * product;
+        CHECK(std::is_same_v<decltype(wide), BasicFraction<int128_t, OverflowPolicy::Promote>>);
+        CHECK_EQ(wide.getNumerator(), int128_t{1} << 124);
+        CHECK_THROWS_AS(wide * wide, std::overflow_error);
+        CHECK_THROWS_AS(PromotingFraction(1, 2) / PromotingFraction(), std::runtime_error);
+        // Promoted results convert back to the default policy without loss
+        Fraction64 converted = sum;
+        CHECK_EQ(converted, Fraction64(2LL * max_int, 1));
+    }
+
+    TEST_CASE("Unchecked wraps around") {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        CHECK_EQ(WrappingFraction(max_int, 1) + WrappingFraction(1, 1), WrappingFraction(min_int, 1));
+        CHECK_EQ(WrappingFraction(min_int, 1) - WrappingFraction(1, 1), WrappingFraction(max_int, 1));
+        // The wide intermediate results are exact, so results that fit are correct
+        std::mt19937 engine(12);
+        std::uniform_int_distribution<int> values(-1000, 1000);
+        for (int i = 0; i < 1000; i++) {
+            int numerators[] = {values(engine), values(engine)};
+            int denominators[] = {values(engine), values(engine)};
+            if (denominators[0] == 0 || denominators[1] == 0 || numerators[1] == 0) {
+                continue;
+            }
+            Fraction lhs(numerators[0], denominators[0]);
+            Fraction rhs(numerators[1], denominators[1]);
+            WrappingFraction wrapping_lhs(lhs);
+            WrappingFraction wrapping_rhs(rhs);
+            CHECK_EQ(Fraction(wrapping_lhs + wrapping_rhs), lhs + rhs);
+            CHECK_EQ(Fraction(wrapping_lhs - wrapping_rhs), lhs - rhs);
+            CHECK_EQ(Fraction(wrapping_lhs * wrapping_rhs), lhs * rhs);
+            CHECK_EQ(Fraction(wrapping_lhs / wrapping_rhs), lhs / rhs);
+        }
+        // Division by zero is not checked either
+        CHECK_EQ((WrappingFraction(3, 2) / WrappingFraction()).getDenominator(), 0);
+        CHECK_EQ((WrappingFraction() / WrappingFraction()).getDenominator(), 0);
+        // 128-bit values wrap in 128 bits
+        int128_t max128 = FractionTraits<int128_t>::max();
+        using Wrapping128 = BasicFraction<int128_t, OverflowPolicy::Unchecked>;
+        CHECK_EQ((Wrapping128(max128, 1) + Wrapping128(1, 1)).getNumerator(), FractionTraits<int128_t>::min());
+    }
+}
+
+TEST_SUITE("CompactFraction") {
+
+    static_assert(sizeof(CompactFraction) == sizeof(std::uint32_t));
+    static_assert(CompactFraction(Fraction(-3, 4)).toFraction() == Fraction(-3, 4));
+
+    TEST_CASE("Round trips through Fraction") {
+        std::mt19937 engine(13);
+        std::uniform_int_distribution<int> numerators(std::numeric_limits<std::int16_t>::min(),
+                                                      std::numeric_limits<std::int16_t>::max());
+        std::uniform_int_distribution<int> denominators(1, CompactFraction::MAX_DENOMINATOR);
+        for (int i = 0; i < 10000; i++) {
+            Fraction fraction(numerators(engine), denominators(engine));
+            CompactFraction compact(fraction);
+            CHECK_EQ(compact.toFraction(), fraction);
+            CHECK_EQ(compact.getNumerator(), fraction.getNumerator());
+            CHECK_EQ(CompactFraction::fromBits(compact.bits()), compact);
+        }
+        CHECK_EQ(CompactFraction().toFraction(), Fraction());
+        CHECK_EQ(CompactFraction(Fraction(-32768, 65535)).toFraction(), Fraction(-32768, 65535));
+    }
+
+    TEST_CASE("Values that do not fit are rejected") {
+        CHECK_THROWS_AS(CompactFraction(Fraction(32768, 1)), std::overflow_error);
+        CHECK_THROWS_AS(CompactFraction(Fraction(-32769, 1)), std::overflow_error);
+        CHECK_THROWS_AS(CompactFraction(Fraction(1, 65536)), std::overflow_error);
+        CHECK_EQ(CompactFraction::try_from(Fraction(1, 65536)).error(), FractionError::Overflow);
+        // Only the reduced terms matter
+        CHECK_EQ(CompactFraction(Fraction(65536, 131072)).toFraction(), Fraction(1, 2));
+    }
+
+    TEST_CASE("Comparison matches Fraction") {
+        std::mt19937 engine(14);
+        std::uniform_int_distribution<int> numerators(-32768, 32767);
+        std::uniform_int_distribution<int> denominators(1, 65535);
+        for (int i = 0; i < 10000; i++) {
+            Fraction lhs(numerators(engine), i % 2 == 0 ? denominators(engine) : 65535);
+            Fraction rhs(numerators(engine), denominators(engine));
+            CHECK((CompactFraction(lhs) <=> CompactFraction(rhs)) == (lhs <=> rhs));
+            CHECK_EQ(CompactFraction(lhs) == CompactFraction(rhs), lhs == rhs);
+        }
+    }
+
+    TEST_CASE("CompactFractionVector") {
+        CompactFractionVector values{Fraction(1, 2), Fraction(-7, 3)};
+        CHECK_EQ(values.size(), 2);
+        CHECK_EQ(values[1], Fraction(-7, 3));
+        values.push_back(Fraction(5, 65535));
+        values.set(0, Fraction(-1, 4));
+        CHECK_EQ(values[0], Fraction(-1, 4));
+        CHECK_THROWS_AS(values.push_back(Fraction(1 << 20, 3)), std::overflow_error);
+        CHECK_THROWS_AS(values.set(1, Fraction(1, 1 << 20)), std::overflow_error);
+        CHECK_EQ(values.size(), 3);
+        CHECK_EQ(values[1], Fraction(-7, 3));
+        int count = 0;
+        for (CompactFraction value: values) {
+            count += value < CompactFraction() ? 1 : 0;
+        }
+        CHECK_EQ(count, 2);
+        values.resize(5);
+        CHECK_EQ(values[4], Fraction());
+        CompactFractionVector copy(std::vector<Fraction>{Fraction(2, 3)});
+        CHECK_EQ(copy[0], Fraction(2, 3));
+        values.clear();
+        CHECK(values.empty());
+    }
+}
+
+TEST_SUITE("Fraction hashing") {
+
+    TEST_CASE("std::hash agrees with equality") {
+        CHECK_EQ(std::hash<Fraction>{}(Fraction(2, 4)), std::hash<Fraction>{}(Fraction(-1, -2)));
+        CHECK_NE(std::hash<Fraction>{}(Fraction(1, 2)), std::hash<Fraction>{}(Fraction(2, 1)));
+        CHECK_EQ(std::hash<Fraction128>{}(Fraction128(6, 9)), std::hash<Fraction128>{}(Fraction128(2, 3)));
+        std::unordered_set<Fraction> values{Fraction(1, 2), Fraction(2, 4), Fraction(3, 6), Fraction(1, 3)};
+        CHECK_EQ(values.size(), 2);
+        std::unordered_set<Fraction64> wide{Fraction64(1, 2), Fraction64(2, 4)};
+        CHECK_EQ(wide.size(), 1);
+    }
+
+    TEST_CASE("FractionHashMap matches std::unordered_map") {
+        std::mt19937 engine(15);
+        std::uniform_int_distribution<int> terms(-50, 50);
+        std::uniform_int_distribution<int> operations(0, 3);
+        FractionHashMap<int> map;
+        std::unordered_map<Fraction, int> expected;
+        for (int i = 0; i < 20000; i++) {
+            int denominator = terms(engine);
+            Fraction key(terms(engine), denominator == 0 ? 1 : denominator);
+            switch (operations(engine)) {
+                case 0:
+                    map[key] += i;
+                    expected[key] += i;
+                    break;
+                case 1:
+                    CHECK_EQ(map.insert(key, i), expected.emplace(key, i).second);
+                    break;
+                case 2:
+                    CHECK_EQ(map.erase(key), expected.erase(key) == 1);
+                    break;
+                default:
+                    CHECK_EQ(map.contains(key), expected.count(key) == 1);
+                    if (const int *value = map.find(key)) {
+                        CHECK_EQ(*value, expected[key]);
+                    }
+                    break;
+            }
+            REQUIRE_EQ(map.size(), expected.size());
+        }
+        std::size_t visited = 0;
+        map.for_each([&](const Fraction &key, int value) {
+            CHECK_EQ(expected.at(key), value);
+            visited++;
+        });
+        CHECK_EQ(visited, expected.size());
+        map.clear();
+        CHECK(map.empty());
+        CHECK_EQ(map.find(Fraction(1, 2)), nullptr);
+    }
+
+    TEST_CASE("FractionHashSet deduplicates") {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        FractionHashSet set;
+        set.reserve(100);
+        CHECK(set.insert(Fraction(1, 2)));
+        CHECK_FALSE(set.insert(Fraction(50, 100)));
+        CHECK(set.insert(Fraction()));
+        CHECK(set.insert(Fraction(min_int, 1)));
+        CHECK(set.insert(Fraction(1, max_int)));
+        for (int i = 1; i <= 1000; i++) {
+            set.insert(Fraction(i % 37, i));
+        }
+        CHECK(set.contains(Fraction(0, 5)));
+        CHECK(set.contains(Fraction(min_int, 1)));
+        CHECK_FALSE(set.contains(Fraction(3, 1)));
+        std::unordered_set<Fraction> expected{Fraction(1, 2), Fraction(), Fraction(min_int, 1), Fraction(1, max_int)};
+        for (int i = 1; i <= 1000; i++) {
+            expected.insert(Fraction(i % 37, i));
+        }
+        CHECK_EQ(set.size(), expected.size());
+        set.for_each([&](const Fraction &key) { CHECK_EQ(expected.count(key), 1); });
+        CHECK(set.erase(Fraction(1, 2)));
+        CHECK_FALSE(set.erase(Fraction(1, 2)));
+        CHECK_FALSE(set.contains(Fraction(1, 2)));
+        CHECK_EQ(set.size(), expected.size() - 1);
+    }
+}
+
+TEST_SUITE("Sorting") {
+
+    // Random fractions with many duplicates and many values closer together than a double can tell apart
+    vector<Fraction> sortInput(std::size_t size, unsigned seed) {
+        std::mt19937 engine(seed);
+        std::uniform_int_distribution<int> kind(0, 2);
+        std::uniform_int_distribution<int> small(-20, 20);
+        std::uniform_int_distribution<int> large(numeric_limits<int>::max() - 1000, numeric_limits<int>::max());
+        vector<Fraction> values;
+        values.reserve(size);
+        for (std::size_t i = 0; i < size; i++) {
+            switch (kind(engine)) {
+                case 0:
+                    values.emplace_back(small(engine), small(engine) % 7 + 8);
+                    break;
+                case 1:
+                    values.emplace_back(large(engine), large(engine));
+                    break;
+                default:
+                    values.emplace_back(large(engine) - 1, large(engine) - 1000);
+                    break;
+            }
+        }
+        return values;
+    }
+
+    TEST_CASE("sort orders exactly") {
+        for (std::size_t size: {std::size_t{0}, std::size_t{1}, std::size_t{1000}, std::size_t{200000}}) {
+            vector<Fraction> input = sortInput(size, static_cast<unsigned>(size));
+            vector<Fraction> expected = input;
+            std::sort(expected.begin(), expected.end());
+            for (SortOptions options: {SortOptions{.threads = 1}, SortOptions{.threads = 4},
+                                       SortOptions{.threads = 1, .precompute_keys = true},
+                                       SortOptions{.threads = 3, .precompute_keys = true}}) {
+                vector<Fraction> values = input;
+                ariel::sort(values, options);
+                CHECK(values == expected);
+            }
+        }
+    }
+
+    TEST_CASE("Close values are ordered by the exact comparison") {
+        // They differ by about 2^-62, far below the spacing of doubles near 1
+        int max = numeric_limits<int>::max();
+        vector<Fraction> values{Fraction(max - 1, max), Fraction(max - 2, max - 1), Fraction(max - 1, max)};
+        CHECK_EQ(static_cast<double>(max - 1) / max, static_cast<double>(max - 2) / (max - 1));
+        ariel::sort(values, {.threads = 1, .precompute_keys = true});
+        CHECK(values == vector<Fraction>{Fraction(max - 2, max - 1), Fraction(max - 1, max), Fraction(max - 1, max)});
+    }
+
+    TEST_CASE("nth_element and partial_sort") {
+        vector<Fraction> input = sortInput(5000, 16);
+        vector<Fraction> expected = input;
+        std::sort(expected.begin(), expected.end());
+        vector<Fraction> values = input;
+        ariel::nth_element(values, 2500);
+        CHECK_EQ(values[2500], expected[2500]);
+        CHECK(std::all_of(values.begin(), values.begin() + 2500, [&](const Fraction &value) {
+            return value <= expected[2500];
+        }));
+        CHECK(std::all_of(values.begin() + 2500, values.end(), [&](const Fraction &value) {
+            return value >= expected[2500];
+        }));
+
+        values = input;
+        ariel::partial_sort(values, 100);
+        CHECK(std::equal(values.begin(), values.begin() + 100, expected.begin()));
+
+        values = input;
+        ariel::nth_element(values, values.size());
+        CHECK(values == input);
+        ariel::partial_sort(values, values.size() + 10);
+        CHECK(values == expected);
+    }
+}
+
+TEST_SUITE("Reductions") {
+
+    vector<Fraction> reduceInput(std::size_t size, int max_denominator, unsigned seed) {
+        std::mt19937 engine(seed);
+        std::uniform_int_distribution<int> numerators(numeric_limits<int>::min(), numeric_limits<int>::max());
+        std::uniform_int_distribution<int> denominators(1, max_denominator);
+        vector<Fraction> values;
+        values.reserve(size);
+        for (std::size_t i = 0; i < size; i++) {
+            values.emplace_back(numerators(engine), denominators(engine));
+        }
+        return values;
+    }
+
+    TEST_CASE("sum matches BigFraction accumulation") {
+        CHECK_EQ(ariel::sum(vector<Fraction>{}), BigFraction());
+        CHECK_EQ(ariel::sum(vector<Fraction>{Fraction(1, 2), Fraction(1, 3), Fraction(-1, 6)}), BigFraction(2, 3));
+        // The exact sum of random large denominators grows to thousands of digits, so those inputs are short
+        for (auto [size, max_denominator]: {std::pair{100000, 1}, std::pair{100000, 60}, std::pair{2000, 100000}}) {
+            vector<Fraction> values = reduceInput(static_cast<std::size_t>(size), max_denominator,
+                                                  static_cast<unsigned>(max_denominator));
+            BigFraction expected;
+            for (const Fraction &value: values) {
+                expected += value;
+            }
+            CHECK_EQ(ariel::sum(values, {.threads = 1}), expected);
+            CHECK_EQ(ariel::sum(values, {.threads = 4}), expected);
+        }
+        // Adding the same values as Fraction overflows after a few terms
+        vector<Fraction> values = reduceInput(100, 60, 1);
+        CHECK_THROWS_AS((void) std::accumulate(values.begin(), values.end(), Fraction()), std::overflow_error);
+    }
+
+    TEST_CASE("dot and mean") {
+        vector<Fraction> lhs = reduceInput(100000, 30, 17);
+        vector<Fraction> rhs = reduceInput(100000, 30, 18);
+        BigFraction expected;
+        for (std::size_t i = 0; i < lhs.size(); i++) {
+            expected += BigFraction(lhs[i]) * BigFraction(rhs[i]);
+        }
+        CHECK_EQ(ariel::dot(lhs, rhs, {.threads = 1}), expected);
+        CHECK_EQ(ariel::dot(lhs, rhs, {.threads = 3}), expected);
+        vector<Fraction> terms{Fraction(1, 2), Fraction(2, 3)};
+        CHECK_EQ(ariel::dot(terms, vector<Fraction>{Fraction(3, 1), Fraction(-3, 4)}), BigFraction(1, 1));
+        CHECK_THROWS_AS(ariel::dot(lhs, std::span<const Fraction>(rhs).subspan(1)), std::invalid_argument);
+
+        CHECK_EQ(ariel::mean(vector<Fraction>{Fraction(1, 2), Fraction(1, 3)}), BigFraction(5, 12));
+        CHECK_EQ(ariel::mean(lhs, {.threads = 2}) * BigFraction(static_cast<int>(lhs.size()), 1), ariel::sum(lhs));
+        CHECK_THROWS_AS(ariel::mean(vector<Fraction>{}), std::invalid_argument);
+    }
+}
+
+TEST_SUITE("LazyFraction") {
+
+    TEST_CASE("Chains match the eager operators") {
+        std::mt19937 engine(18);
+        std::uniform_int_distribution<int> terms(-1000, 1000);
+        std::uniform_int_distribution<int> denominators(1, 1000);
+        for (int i = 0; i < 10000; i++) {
+            Fraction a(terms(engine), denominators(engine));
+            Fraction b(terms(engine), denominators(engine));
+            Fraction c(terms(engine), denominators(engine));
+            Fraction d(terms(engine), denominators(engine));
+            Fraction eager;
+            try {
+                eager = (a + b - c * d) / (d == Fraction() ? Fraction(1, 1) : d);
+            } catch (const std::overflow_error &) {
+                continue;
+            }
+            LazyFraction lazy = (LazyFraction(a) + b - c * LazyFraction(d)) / (d == Fraction() ? Fraction(1, 1) : d);
+            CHECK_EQ(lazy.toFraction(), eager);
+            CHECK_EQ(lazy.getNumerator(), eager.getNumerator());
+            CHECK_EQ(lazy.getDenominator(), eager.getDenominator());
+            CHECK((lazy < LazyFraction(a)) == (eager < a));
+            CHECK_EQ(std::hash<LazyFraction>{}(lazy), std::hash<LazyFraction>{}(LazyFraction(eager)));
+        }
+    }
+
+    TEST_CASE("Observation reduces") {
+        LazyFraction value = LazyFraction(1, 2) + LazyFraction(1, 2);
+        CHECK_EQ(value, LazyFraction(1, 1));
+        CHECK_EQ(value, Fraction(2, 2));
+        CHECK_EQ(value.getNumerator(), 1);
+        CHECK_EQ(value.getDenominator(), 1);
+        std::ostringstream stream;
+        stream << LazyFraction(3, -6) * LazyFraction(4, 1);
+        CHECK_EQ(stream.str(), "-2/1");
+        CHECK(Fraction(1, 3) + LazyFraction(1, 6) == Fraction(1, 2));
+        CHECK(Fraction(1, 3) < LazyFraction(1, 2));
+        value = LazyFraction(6, 8);
+        value.simplify();
+        CHECK_EQ(value.toFraction(), Fraction(3, 4));
+        value /= Fraction(-3, 2);
+        value *= Fraction(2, 1);
+        value -= Fraction(1, 1);
+        value += Fraction(1, 2);
+        CHECK_EQ(value.toFraction(), Fraction(-3, 2));
+    }
+
+    TEST_CASE("Intermediate values may leave the int range") {
+        int max = numeric_limits<int>::max();
+        CHECK_THROWS_AS((void) (Fraction(max, 1) + Fraction(max, 1)), std::overflow_error);
+        LazyFraction doubled = LazyFraction(max, 1) + Fraction(max, 1);
+        CHECK_THROWS_AS((void) doubled.toFraction(), std::overflow_error);
+        CHECK_EQ(doubled.getNumerator(), 2 * std::int64_t{max});
+        CHECK_EQ((doubled - Fraction(max, 1)).toFraction(), Fraction(max, 1));
+        // Long chains reduce whenever the terms outgrow 64 bits
+        LazyFraction sum;
+        for (int i = 1; i <= 1000; i++) {
+            sum += LazyFraction(1, i * (i + 1));
+        }
+        CHECK_EQ(sum.toFraction(), Fraction(1000, 1001));
+        LazyFraction squared = LazyFraction(max, 1) * Fraction(max, 1);
+        CHECK_THROWS_AS((void) (squared * Fraction(max, 1)), std::overflow_error);
+        CHECK_THROWS_AS((void) LazyFraction(1, 0), std::invalid_argument);
+        CHECK_THROWS_AS((void) (LazyFraction(1, 2) / LazyFraction()), std::runtime_error);
+    }
+
+    TEST_CASE("Constant expressions") {
+        constexpr LazyFraction value = (LazyFraction(1, 2) + Fraction(1, 3)) * Fraction(6, 5);
+        static_assert(value == Fraction(1, 1));
+        static_assert(value.toFraction() == Fraction(1, 1));
+        CHECK_EQ(value.getDenominator(), 1);
+    }
+}
+
+TEST_SUITE("Expression templates") {
+
+    TEST_CASE("Expressions match the eager operators") {
+        std::mt19937 engine(19);
+        std::uniform_int_distribution<int> terms(-1000, 1000);
+        std::uniform_int_distribution<int> denominators(1, 1000);
+        for (int i = 0; i < 10000; i++) {
+            Fraction a(terms(engine), denominators(engine));
+            Fraction b(terms(engine), denominators(engine));
+            Fraction c(terms(engine), denominators(engine));
+            Fraction d(terms(engine) | 1, denominators(engine));
+            Fraction eager;
+            try {
+                eager = (a + b - c * d) / d - Fraction(3, 1);
+            } catch (const std::overflow_error &) {
+                continue;
+            }
+            Fraction fused = (expr(a) + b - c * expr(d)) / d - 3;
+            CHECK_EQ(fused, eager);
+        }
+    }
+
+    TEST_CASE("Conversion and operands") {
+        Fraction a(5, 3);
+        Fraction b(14, 21);
+        Fraction c = expr(a) + b - 1;
+        CHECK_EQ(c, Fraction(4, 3));
+        CHECK_EQ((1 - expr(a) * 3).evaluate(), Fraction(-4, 1));
+        CHECK_EQ(Fraction(expr(a) / b), Fraction(5, 2));
+        CHECK_EQ(Fraction((expr(a) - b) * (expr(a) + b)), a * a - b * b);
+        // Plain Fraction arithmetic is unaffected
+        static_assert(std::is_same_v<decltype(a + b), Fraction>);
+        static_assert(!std::is_same_v<decltype(expr(a) + b), Fraction>);
+        constexpr Fraction folded = (expr(Fraction(1, 2)) + Fraction(1, 3)) * 6;
+        static_assert(folded == Fraction(5, 1));
+    }
+
+    TEST_CASE("Intermediate values") {
+        int max = numeric_limits<int>::max();
+        Fraction big(max, 1);
+        CHECK_THROWS_AS((void) (big + big - big), std::overflow_error);
+        CHECK_EQ(Fraction(expr(big) + big - big), big);
+        // The intermediate product needs more than 128 bits, the BigFraction fallback keeps it exact
+        Fraction tiny(1, max);
+        CHECK_EQ(Fraction(expr(big) * big * big * big * big / big / big / big / big), big);
+        CHECK_EQ(Fraction(expr(tiny) * tiny * tiny * tiny * tiny / tiny / tiny / tiny / tiny), tiny);
+        CHECK_THROWS_AS((void) Fraction(expr(big) * 2), std::overflow_error);
+        CHECK_THROWS_AS((void) Fraction(expr(big) * big * big * big * big), std::overflow_error);
+        CHECK_THROWS_AS((void) Fraction(expr(big) / (expr(big) - big)), std::runtime_error);
+    }
+}
+
+TEST_SUITE("Operation counters") {
+
+    // Everything is zero unless the tests are built with make STATS=1
+    std::uint64_t expected(std::uint64_t count) {
+        return STATS_ENABLED ? count : 0;
+    }
+
+    TEST_CASE("Operators are counted") {
+        reset_stats();
+        Fraction a(6, 8);
+        Fraction b(1, 3);
+        Fraction c = a + b;
+        c = c - b;
+        c = c * a;
+        c = c / b;
+        CHECK_FALSE(a < b);
+        CHECK_FALSE(a == b);
+        ++c;
+        c--;
+        c.simplify();
+        CHECK_THROWS_AS((void) (Fraction(numeric_limits<int>::max(), 1) + Fraction(1, 1)), std::overflow_error);
+        StatsSnapshot snapshot = stats_snapshot();
+        CHECK_EQ(snapshot[StatCounter::Constructions], expected(4));
+        CHECK_EQ(snapshot[StatCounter::Additions], expected(2));
+        CHECK_EQ(snapshot[StatCounter::Subtractions], expected(1));
+        CHECK_EQ(snapshot[StatCounter::Multiplications], expected(1));
+        CHECK_EQ(snapshot[StatCounter::Divisions], expected(1));
+        CHECK_EQ(snapshot[StatCounter::Comparisons], expected(2));
+        CHECK_EQ(snapshot[StatCounter::Increments], expected(1));
+        CHECK_EQ(snapshot[StatCounter::Decrements], expected(1));
+        CHECK_EQ(snapshot[StatCounter::Simplifications], expected(1));
+        CHECK_EQ(snapshot[StatCounter::OverflowErrors], expected(1));
+        CHECK(snapshot[StatCounter::GcdCalls] >= expected(4));
+        CHECK(snapshot[StatCounter::GcdIterations] >= expected(1));
+        // 6/8 is stored as 3/4: a 2 bit numerator and a 3 bit denominator
+        CHECK(snapshot.numerator_bits[2] >= expected(1));
+        CHECK(snapshot.denominator_bits[3] >= expected(1));
+        std::uint64_t terms = std::accumulate(snapshot.numerator_bits.begin(), snapshot.numerator_bits.end(),
+                                              std::uint64_t{0});
+        CHECK_EQ(terms, expected(8));
+        reset_stats();
+        CHECK_EQ(stats_snapshot()[StatCounter::Additions], 0);
+    }
+
+    TEST_CASE("Counts of other threads") {
+        reset_stats();
+        std::thread worker([] {
+            Fraction sum;
+            for (int i = 1; i <= 100; i++) {
+                sum = sum + Fraction(1, 1);
+            }
+            CHECK_EQ(sum, Fraction(100, 1));
+        });
+        worker.join();
+        // The thread has exited, its counts are kept
+        CHECK_EQ(stats_snapshot()[StatCounter::Additions], expected(100));
+        // Constant evaluation is never counted
+        constexpr Fraction folded = Fraction(1, 2) + Fraction(1, 2);
+        static_assert(folded == Fraction(1, 1));
+        CHECK_EQ(stats_snapshot()[StatCounter::Additions], expected(100));
+    }
+
+    TEST_CASE("Export formats") {
+        StatsSnapshot snapshot;
+        snapshot.counters[static_cast<std::size_t>(StatCounter::Additions)] = 7;
+        snapshot.counters[static_cast<std::size_t>(StatCounter::OverflowErrors)] = 2;
+        snapshot.numerator_bits[3] = 4;
+        snapshot.numerator_bits[5] = 1;
+        string json = to_json(snapshot);
+        CHECK(json.find(STATS_ENABLED ? "\"enabled\":true" : "\"enabled\":false") != string::npos);
+        CHECK(json.find("\"additions\":7") != string::npos);
+        CHECK(json.find("\"overflow_errors\":2") != string::npos);
+        CHECK(json.find("\"numerator_bits\":[0,0,0,4,0,1,0,") != string::npos);
+        CHECK_EQ(json.front(), '{');
+        CHECK_EQ(json.back(), '}');
+        string text = to_prometheus(snapshot);
+        CHECK(text.find("# TYPE fraction_operations_total counter\n") != string::npos);
+        CHECK(text.find("fraction_operations_total{operator=\"add\"} 7\n") != string::npos);
+        CHECK(text.find("fraction_overflow_errors_total 2\n") != string::npos);
+        // Cumulative buckets
+        CHECK(text.find("fraction_numerator_bits_bucket{le=\"2\"} 0\n") != string::npos);
+        CHECK(text.find("fraction_numerator_bits_bucket{le=\"4\"} 4\n") != string::npos);
+        CHECK(text.find("fraction_numerator_bits_bucket{le=\"+Inf\"} 5\n") != string::npos);
+        CHECK(text.find("fraction_numerator_bits_sum 17\n") != string::npos);
+        CHECK(text.find("fraction_numerator_bits_count 5\n") != string::npos);
+    }
+}
+
+TEST_SUITE("AtomicFraction") {
+
+    TEST_CASE("Load, store and exchange") {
+        AtomicFraction value;
+        CHECK(AtomicFraction::is_always_lock_free);
+        CHECK_EQ(value.load(), Fraction(0, 1));
+        value.store(Fraction(-6, 8));
+        CHECK_EQ(value.load(), Fraction(-3, 4));
+        value = Fraction(numeric_limits<int>::min(), numeric_limits<int>::max());
+        CHECK_EQ(Fraction(value), Fraction(numeric_limits<int>::min(), numeric_limits<int>::max()));
+        CHECK_EQ(value.exchange(Fraction(1, 3)), Fraction(numeric_limits<int>::min(), numeric_limits<int>::max()));
+        CHECK_EQ(value.load(std::memory_order_acquire), Fraction(1, 3));
+    }
+
+    TEST_CASE("Compare exchange") {
+        AtomicFraction value(Fraction(1, 2));
+        Fraction expected(2, 4);
+        CHECK(value.compare_exchange_strong(expected, Fraction(2, 3)));
+        CHECK_EQ(value.load(), Fraction(2, 3));
+        // On failure expected receives the current value
+        CHECK_FALSE(value.compare_exchange_strong(expected, Fraction(5, 1)));
+        CHECK_EQ(expected, Fraction(2, 3));
+        CHECK_EQ(value.load(), Fraction(2, 3));
+        while (!value.compare_exchange_weak(expected, Fraction(-1, 7), std::memory_order_acq_rel)) {
+        }
+        CHECK_EQ(value.load(), Fraction(-1, 7));
+    }
+
+    TEST_CASE("Arithmetic updates return the previous value") {
+        AtomicFraction value(Fraction(1, 2));
+        CHECK_EQ(value.fetch_add(Fraction(1, 3)), Fraction(1, 2));
+        CHECK_EQ(value.fetch_sub(Fraction(1, 6)), Fraction(5, 6));
+        CHECK_EQ(value.fetch_mul(Fraction(3, 4)), Fraction(2, 3));
+        CHECK_EQ(value.fetch_div(Fraction(1, 4)), Fraction(1, 2));
+        CHECK_EQ(value.load(), Fraction(2, 1));
+        CHECK_EQ(value.fetch_update([](const Fraction &current) { return current * current; }), Fraction(2, 1));
+        CHECK_EQ(value.load(), Fraction(4, 1));
+        // A failed update leaves the value unchanged
+        CHECK_THROWS_AS(value.fetch_div(Fraction(0, 1)), std::runtime_error);
+        value.store(Fraction(numeric_limits<int>::max(), 1));
+        CHECK_THROWS_AS(value.fetch_add(Fraction(1, 1)), std::overflow_error);
+        CHECK_EQ(value.load(), Fraction(numeric_limits<int>::max(), 1));
+    }
+
+    TEST_CASE("Concurrent updates are not lost") {
+        const int threads = 4;
+        const int updates = 2000;
+        AtomicFraction sum;
+        AtomicFraction product(Fraction(1, 1));
+        vector<std::thread> workers;
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back([&] {
+                for (int j = 0; j < updates; j++) {
+                    sum.fetch_add(Fraction(1, 4));
+                    // Multiplying by 2 and by 1/2 in any order keeps the product within range
+                    product.fetch_mul(j % 2 == 0 ? Fraction(2, 1) : Fraction(1, 2));
+                }
+            });
+        }
+        for (std::thread &worker: workers) {
+            worker.join();
+        }
+        CHECK_EQ(sum.load(), Fraction(threads * updates / 4, 1));
+        CHECK_EQ(product.load(), Fraction(1, 1));
+    }
+}
+
+TEST_SUITE("ShardedFractionAccumulator") {
+
+    TEST_CASE("Single thread") {
+        ShardedFractionAccumulator accumulator(4);
+        CHECK_EQ(accumulator.shardCount(), 4);
+        CHECK_EQ(accumulator.snapshot(), BigFraction());
+        accumulator.add(Fraction(1, 2));
+        accumulator.add(Fraction(1, 3));
+        accumulator.add(Fraction(-1, 6));
+        CHECK_EQ(accumulator.snapshot(), BigFraction(Fraction(2, 3)));
+        // Sums that no Fraction can hold
+        int max = numeric_limits<int>::max();
+        for (int i = 0; i < 10; i++) {
+            accumulator.add(Fraction(max, max - i));
+        }
+        BigFraction expected(Fraction(2, 3));
+        for (int i = 0; i < 10; i++) {
+            expected += BigFraction(Fraction(max, max - i));
+        }
+        CHECK_EQ(accumulator.snapshot(), expected);
+        accumulator.reset();
+        CHECK_EQ(accumulator.snapshot(), BigFraction());
+        accumulator.add(Fraction(5, 7));
+        CHECK_EQ(accumulator.snapshot(), BigFraction(Fraction(5, 7)));
+        CHECK(ShardedFractionAccumulator().shardCount() >= 1);
+    }
+
+    TEST_CASE("Threads sharing shards") {
+        // More threads than shards, so some of them share a shard
+        const int threads = 6;
+        const int updates = 3000;
+        ShardedFractionAccumulator accumulator(4);
+        vector<std::thread> workers;
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back([&accumulator, i] {
+                for (int j = 1; j <= updates; j++) {
+                    accumulator.add(Fraction(i + 1, j % 60 + 1));
+                }
+            });
+        }
+        for (std::thread &worker: workers) {
+            worker.join();
+        }
+        vector<Fraction> values;
+        for (int i = 0; i < threads; i++) {
+            for (int j = 1; j <= updates; j++) {
+                values.emplace_back(i + 1, j % 60 + 1);
+            }
+        }
+        CHECK_EQ(accumulator.snapshot(), ariel::sum(values));
+    }
+}
+
+TEST_SUITE("Fraction files") {
+
+    string tempPath(const string &name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    TEST_CASE("Round trip") {
+        string path = tempPath("fraction_file_round_trip.frac");
+        mt19937 engine(24);
+        uniform_int_distribution<int> terms(-100000, 100000);
+        vector<Fraction> values;
+        for (int i = 0; i < 1000; i++) {
+            values.emplace_back(terms(engine), terms(engine) | 1);
+        }
+        {
+            FractionFileWriter writer(path, 64);
+            writer.write(values[0]);
+            writer.write(std::span<const Fraction>(values).subspan(1));
+            writer.close();
+            CHECK_THROWS_AS(writer.close(), std::runtime_error);
+        }
+        FractionFileReader reader(path);
+        CHECK_EQ(reader.size(), values.size());
+        // 15 full chunks and one of 40
+        REQUIRE_EQ(reader.chunkCount(), 16);
+        CHECK_EQ(reader.chunk(15).size(), 40);
+        size_t index = 0;
+        BigFraction total;
+        for (size_t i = 0; i < reader.chunkCount(); i++) {
+            FractionChunk chunk = reader.chunk(i);
+            CHECK_EQ(reinterpret_cast<std::uintptr_t>(chunk.numerators.data()) % 32, 0);
+            CHECK_EQ(reinterpret_cast<std::uintptr_t>(chunk.denominators.data()) % 32, 0);
+            CHECK_EQ(chunk.min_numerator, *std::min_element(chunk.numerators.begin(), chunk.numerators.end()));
+            CHECK_EQ(chunk.max_numerator, *std::max_element(chunk.numerators.begin(), chunk.numerators.end()));
+            CHECK_EQ(chunk.min_denominator, *std::min_element(chunk.denominators.begin(), chunk.denominators.end()));
+            CHECK_EQ(chunk.max_denominator, *std::max_element(chunk.denominators.begin(), chunk.denominators.end()));
+            for (size_t j = 0; j < chunk.size(); j++) {
+                CHECK_EQ(chunk[j], values[index++]);
+            }
+            // The columns go straight into the batch kernels
+            total += ariel::sum(chunk.numerators, chunk.denominators);
+        }
+        CHECK_EQ(total, ariel::sum(values));
+        CHECK_THROWS_AS(reader.chunk(16), std::out_of_range);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("Empty and unclosed files") {
+        string path = tempPath("fraction_file_empty.frac");
+        FractionFileWriter(path).close();
+        CHECK_EQ(FractionFileReader(path).size(), 0);
+        CHECK_EQ(FractionFileReader(path).chunkCount(), 0);
+        {
+            // The destructor closes the file
+            FractionFileWriter writer(path);
+            writer.write(Fraction(1, 3));
+        }
+        FractionFileReader reader(path);
+        REQUIRE_EQ(reader.size(), 1);
+        CHECK_EQ(reader.chunk(0)[0], Fraction(1, 3));
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("Invalid files") {
+        CHECK_THROWS_AS(FractionFileWriter(tempPath("fraction_file_zero.frac"), 0), std::invalid_argument);
+        CHECK_THROWS_AS(FractionFileReader{tempPath("fraction_file_missing.frac")}, std::runtime_error);
+        string path = tempPath("fraction_file_invalid.frac");
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << "1/2 3/4 5/6 7/8 9/10 11/12 13/14 15/16";
+        }
+        CHECK_THROWS_AS(FractionFileReader{path}, std::runtime_error);
+        // A truncated file
+        {
+            FractionFileWriter writer(path, 8);
+            for (int i = 1; i <= 20; i++) {
+                writer.write(Fraction(1, i));
+            }
+        }
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 32);
+        CHECK_THROWS_AS(FractionFileReader{path}, std::runtime_error);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("Columns outside of the chunk bounds") {
+        string path = tempPath("fraction_file_columns.frac");
+        {
+            FractionFileWriter writer(path, 8);
+            for (int i = 1; i <= 16; i++) {
+                writer.write(Fraction(1, i + 1));
+            }
+        }
+        // The headers stay valid: a 32 byte file header, a 32 byte chunk header and 8 numerators before the
+        // first denominator
+        const std::streamoff first_denominator = 32 + 32 + 8 * sizeof(int);
+        for (int denominator: {0, -3, 100}) {
+            {
+                std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+                file.seekp(first_denominator);
+                file.write(reinterpret_cast<const char *>(&denominator), sizeof(denominator));
+            }
+            FractionFileReader reader(path);
+            CHECK_THROWS_AS(reader.chunk(0), std::runtime_error);
+            CHECK_EQ(reader.chunk(1)[0], Fraction(1, 10));
+        }
+        std::filesystem::remove(path);
+
+        // The column sum checks its denominators too, since its spans need not come from a file
+        vector<int> numerators{1, 2, 3};
+        vector<int> denominators{1, 0, 1};
+        CHECK_THROWS_AS(ariel::sum(numerators, denominators), std::invalid_argument);
+        denominators[1] = -5;
+        CHECK_THROWS_AS(ariel::sum(numerators, denominators), std::invalid_argument);
+        denominators[1] = 5;
+        CHECK_EQ(ariel::sum(numerators, denominators), BigFraction(22, 5));
+    }
+}
+
+TEST_SUITE("Fraction codec") {
+
+    // Every instruction set the processor supports, the decoder uses SSE for both vector levels
+    std::vector<FractionVector::SimdLevel> codecLevels() {
+        std::vector<FractionVector::SimdLevel> levels{FractionVector::SimdLevel::Scalar};
+        if (FractionVector::supportedSimdLevel() >= FractionVector::SimdLevel::Sse4) {
+            levels.push_back(FractionVector::SimdLevel::Sse4);
+        }
+        return levels;
+    }
+
+    // Small terms with a few values of every byte length, including the int limits
+    std::vector<Fraction> codecFractions(std::size_t count, unsigned seed) {
+        int max_int = std::numeric_limits<int>::max();
+        int min_int = std::numeric_limits<int>::min();
+        std::mt19937 engine(seed);
+        std::uniform_int_distribution<int> small(-300, 300);
+        std::uniform_int_distribution<int> large(min_int, max_int);
+        std::uniform_int_distribution<int> bits(0, 30);
+        std::vector<Fraction> result;
+        for (std::size_t i = 0; i < count; i++) {
+            int numerator = i % 7 == 0 ? large(engine) : small(engine);
+            int denominator = i % 5 == 0 ? 1 << bits(engine) : std::abs(small(engine)) + 1;
+            result.emplace_back(numerator, denominator);
+        }
+        result[0] = Fraction(min_int, 1);
+        result[1] = Fraction(max_int, max_int - 1);
+        result[2] = Fraction(0, 1);
+        return result;
+    }
+
+    TEST_CASE("Round trip") {
+        const FractionVector::SimdLevel original = FractionVector::simdLevel();
+        for (FractionVector::SimdLevel level: codecLevels()) {
+            FractionVector::setSimdLevel(level);
+            // Sizes around the 4 values of a control byte and the 16 bytes of a vector load
+            const std::size_t counts[] = {0, 1, 3, 4, 5, 17, 64, 1001};
+            for (std::size_t count: counts) {
+                std::vector<Fraction> values = codecFractions(max(count, size_t{3}), 25);
+                values.resize(count);
+                for (DenominatorCoding coding: {DenominatorCoding::Auto, DenominatorCoding::PerValue,
+                                                DenominatorCoding::Runs}) {
+                    std::vector<std::uint8_t> bytes = encode_fractions(values, coding);
+                    CHECK_EQ(decode_fractions(bytes), values);
+                    FractionVector columns{Fraction(5, 7)};
+                    decode_fractions(bytes, columns);
+                    REQUIRE_EQ(columns.size(), count);
+                    for (std::size_t i = 0; i < count; i++) {
+                        CHECK_EQ(columns.numerators()[i], values[i].getNumerator());
+                        CHECK_EQ(columns.denominators()[i], values[i].getDenominator());
+                    }
+                }
+            }
+        }
+        FractionVector::setSimdLevel(original);
+    }
+
+    TEST_CASE("Encoded sizes") {
+        // A one byte numerator and a one byte denominator take a byte and a quarter control byte each, after
+        // a 3 byte header and the 2 byte data size of each sequence
+        std::vector<Fraction> small;
+        for (int i = 0; i < 1000; i++) {
+            small.emplace_back(i % 100 + 1, 101);
+        }
+        CHECK_EQ(encode_fractions(small, DenominatorCoding::PerValue).size(), 3 + 2 * (2 + 250 + 1000));
+        // With a shared denominator the denominators all but vanish, Auto picks the smaller coding
+        std::vector<std::uint8_t> runs = encode_fractions(small, DenominatorCoding::Runs);
+        // One run: its count, its denominator in 3 bytes and its length of 999 in 4
+        CHECK_EQ(runs.size(), 3 + (2 + 250 + 1000) + 1 + 3 + 4);
+        CHECK_EQ(encode_fractions(small), runs);
+        CHECK_EQ(encode_fractions(small)[0], static_cast<std::uint8_t>(DenominatorCoding::Runs));
+        std::vector<Fraction> mixed = codecFractions(1000, 26);
+        CHECK_EQ(encode_fractions(mixed)[0], static_cast<std::uint8_t>(DenominatorCoding::PerValue));
+        CHECK_LT(encode_fractions(mixed).size(), mixed.size() * sizeof(Fraction) / 2);
+    }
+
+    TEST_CASE("Invalid encodings") {
+        std::vector<std::uint8_t> bytes = encode_fractions(codecFractions(100, 27));
+        // Every truncation is caught, so is a trailing byte
+        for (std::size_t size = 0; size < bytes.size(); size++) {
+            CHECK_THROWS_AS(decode_fractions(std::span<const std::uint8_t>(bytes).first(size)), std::runtime_error);
+        }
+        bytes.push_back(0);
+        CHECK_THROWS_AS(decode_fractions(bytes), std::runtime_error);
+        // An unknown coding, a count larger than the input and control bytes that disagree with the data size
+        CHECK_THROWS_AS(decode_fractions(std::vector<std::uint8_t>{0, 0}), std::runtime_error);
+        CHECK_THROWS_AS(decode_fractions(std::vector<std::uint8_t>{1, 0x80, 0x80, 0x01}), std::runtime_error);
+        CHECK_THROWS_AS(decode_fractions(std::vector<std::uint8_t>{1, 1, 1, 1, 2, 1, 0, 0}), std::runtime_error);
+        // 1/1 encoded by hand decodes, while the stored denominators 2^31 and 2^32 are out of range
+        CHECK_EQ(decode_fractions(std::vector<std::uint8_t>{1, 1, 1, 0, 2, 1, 0, 0}),
+                 std::vector<Fraction>{Fraction(1, 1)});
+        const FractionVector::SimdLevel original = FractionVector::simdLevel();
+        for (FractionVector::SimdLevel level: codecLevels()) {
+            FractionVector::setSimdLevel(level);
+            CHECK_THROWS_AS(decode_fractions(std::vector<std::uint8_t>{1, 1, 1, 0, 2, 4, 3, 0xff, 0xff, 0xff, 0x7f}),
+                            std::runtime_error);
+            CHECK_THROWS_AS(decode_fractions(std::vector<std::uint8_t>{1, 1, 1, 0, 2, 4, 3, 0xff, 0xff, 0xff, 0xff}),
+                            std::runtime_error);
+            // A run length that does not add up to the count
+            CHECK_THROWS_AS(decode_fractions(std::vector<std::uint8_t>{2, 1, 1, 0, 2, 1, 1, 0, 0, 1, 0, 1}),
+                            std::runtime_error);
+        }
+        FractionVector::setSimdLevel(original);
+    }
+}
@@ -0,0 +1,125 @@
+//
+// A lock-free atomic int fraction.
+//
+
+#ifndef FRACTION_B_ATOMICFRACTION_HPP
+#define FRACTION_B_ATOMICFRACTION_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#include "Fraction.hpp"
+
+namespace ariel {
+    // A Fraction that threads can update without a lock. The 8 bytes of the reduced fraction are stored in one
+    // std::atomic<uint64_t>; since the value is always reduced, equal values have equal bits and
+    // compare_exchange compares values. The read-modify-write operations are compare-and-swap loops over the
+    // Fraction operators: if the operator throws, the stored value is left unchanged and the exception
+    // propagates.
+    class AtomicFraction {
+    private:
+        static_assert(sizeof(Fraction) == sizeof(std::uint64_t), "Fraction must fit in one 64-bit word");
+
+        std::atomic<std::uint64_t> packed;
+
+        static std::uint64_t pack(const Fraction& value) { return std::bit_cast<std::uint64_t>(value); }
+
+        // The bits always come from pack, so they hold a reduced fraction
+        static Fraction unpack(std::uint64_t bits) { return std::bit_cast<Fraction>(bits); }
+
+        // The failure order of compare_exchange for a success order, like the single order overloads of std::atomic
+        static constexpr std::memory_order failureOrder(std::memory_order order) {
+            if (order == std::memory_order_acq_rel) {
+                return std::memory_order_acquire;
+            }
+            return order == std::memory_order_release ? std::memory_order_relaxed : order;
+        }
+
+    public:
+        static constexpr bool is_always_lock_free = std::atomic<std::uint64_t>::is_always_lock_free;
+
+        // Creates 0/1
+        AtomicFraction() noexcept : packed(pack(Fraction())) {}
+
+        AtomicFraction(const Fraction& value) noexcept : packed(pack(value)) {}
+
+        AtomicFraction(const AtomicFraction&) = delete;
+
+        AtomicFraction& operator=(const AtomicFraction&) = delete;
+
+        bool is_lock_free() const noexcept { return packed.is_lock_free(); }
+
+        Fraction load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+            return unpack(packed.load(order));
+        }
+
+        void store(const Fraction& value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            packed.store(pack(value), order);
+        }
+
+        operator Fraction() const noexcept { return load(); }
+
+        AtomicFraction& operator=(const Fraction& value) noexcept {
+            store(value);
+            return *this;
+        }
+
+        // Stores value and returns the previous value
+        Fraction exchange(const Fraction& value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return unpack(packed.exchange(pack(value), order));
+        }
+
+        // Stores desired if the value equals expected, otherwise loads the value into expected. The weak
+        // version may fail spuriously and is meant for loops.
+        bool compare_exchange_weak(Fraction& expected, const Fraction& desired,
+                                   std::memory_order order = std::memory_order_seq_cst) noexcept {
+            std::uint64_t expected_bits = pack(expected);
+            if (packed.compare_exchange_weak(expected_bits, pack(desired), order, failureOrder(order))) {
+                return true;
+            }
+            expected = unpack(expected_bits);
+            return false;
+        }
+
+        bool compare_exchange_strong(Fraction& expected, const Fraction& desired,
+                                     std::memory_order order = std::memory_order_seq_cst) noexcept {
+            std::uint64_t expected_bits = pack(expected);
+            if (packed.compare_exchange_strong(expected_bits, pack(desired), order, failureOrder(order))) {
+                return true;
+            }
+            expected = unpack(expected_bits);
+            return false;
+        }
+
+        // Replaces the value with update(value) and returns the previous value. update may be called several
+        // times when other threads store in between, so it should have no side effects.
+        template<typename Update>
+        Fraction fetch_update(Update update, std::memory_order order = std::memory_order_seq_cst) {
+            std::uint64_t current = packed.load(std::memory_order_relaxed);
+            while (!packed.compare_exchange_weak(current, pack(update(unpack(current))), order,
+                                                 std::memory_order_relaxed)) {
+            }
+            return unpack(current);
+        }
+
+        // The arithmetic updates, they return the previous value and throw like the Fraction operators
+        Fraction fetch_add(const Fraction& value, std::memory_order order = std::memory_order_seq_cst) {
+            return fetch_update([&value](const Fraction& current) { return current + value; }, order);
+        }
+
+        Fraction fetch_sub(const Fraction& value, std::memory_order order = std::memory_order_seq_cst) {
+            return fetch_update([&value](const Fraction& current) { return current - value; }, order);
+        }
+
+        Fraction fetch_mul(const Fraction& value, std::memory_order order = std::memory_order_seq_cst) {
+            return fetch_update([&value](const Fraction& current) { return current * value; }, order);
+        }
+
+        Fraction fetch_div(const Fraction& value, std::memory_order order = std::memory_order_seq_cst) {
+            return fetch_update([&value](const Fraction& current) { return current / value; }, order);
+        }
+    };
+}
+
+#endif //FRACTION_B_ATOMICFRACTION_HPP
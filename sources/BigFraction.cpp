@@ -0,0 +1,232 @@
+//
+// Arbitrary precision fraction that never overflows.
+//
+#include "BigFraction.hpp"
+
+#include <cmath>
+#include <string>
+
+namespace ariel {
+
+    BigFraction::BigFraction() : numerator(0), denominator(1) {}
+
+    BigFraction::BigFraction(BigInteger numerator, BigInteger denominator) :
+            numerator(std::move(numerator)), denominator(std::move(denominator)) {
+        if (this->denominator.sign() == 0) {
+            throw std::invalid_argument("Division by zero");
+        }
+        simplify();
+    }
+
+    BigFraction::BigFraction(float f) : numerator(0), denominator(1) {
+        // Same conversion as Fraction: shift the decimal point right up to 3 times
+        int scale = 1;
+        for (int i = 0; i < 3 && f != std::round(f); i++) {
+            f *= 10;
+            scale *= 10;
+        }
+        numerator = BigInteger::fromDouble(std::round(f));
+        denominator = BigInteger(scale);
+        simplify();
+    }
+
+    bool BigFraction::isSmall() const {
+        return numerator.isSmall() && denominator.isSmall();
+    }
+
+    bool BigFraction::isInline() const {
+        return isSmall();
+    }
+
+    const BigInteger &BigFraction::getNumerator() const {
+        return numerator;
+    }
+
+    const BigInteger &BigFraction::getDenominator() const {
+        return denominator;
+    }
+
+    BigFraction BigFraction::fromWide(int128_t numerator, int128_t denominator) {
+        int128_t gcd = FractionTraits<int128_t>::gcd(numerator, denominator);
+        BigFraction result;
+        result.numerator = BigInteger(numerator / gcd);
+        result.denominator = BigInteger(denominator / gcd);
+        return result;
+    }
+
+    void BigFraction::simplify() {
+        BigInteger gcd = BigInteger::gcd(numerator, denominator);
+        if (!(gcd == BigInteger(1))) {
+            numerator = numerator / gcd;
+            denominator = denominator / gcd;
+        }
+        // Keep the denominator positive
+        if (denominator.sign() < 0) {
+            numerator = -numerator;
+            denominator = -denominator;
+        }
+    }
+
+    // Addition operator: Adds two fractions
+    // Inline values are added with 128-bit cross products, which can't overflow for 64-bit inputs
+    BigFraction BigFraction::operator+(const BigFraction &other) const {
+        if (isSmall() && other.isSmall()) {
+            int128_t new_numerator = static_cast<int128_t>(numerator.toInt64()) * other.denominator.toInt64() +
+                                     static_cast<int128_t>(other.numerator.toInt64()) * denominator.toInt64();
+            return fromWide(new_numerator, static_cast<int128_t>(denominator.toInt64()) * other.denominator.toInt64());
+        }
+        return BigFraction(numerator * other.denominator + other.numerator * denominator,
+                           denominator * other.denominator);
+    }
+
+    // Subtraction operator: Subtracts two fractions, same scheme as addition
+    BigFraction BigFraction::operator-(const BigFraction &other) const {
+        if (isSmall() && other.isSmall()) {
+            int128_t new_numerator = static_cast<int128_t>(numerator.toInt64()) * other.denominator.toInt64() -
+                                     static_cast<int128_t>(other.numerator.toInt64()) * denominator.toInt64();
+            return fromWide(new_numerator, static_cast<int128_t>(denominator.toInt64()) * other.denominator.toInt64());
+        }
+        return BigFraction(numerator * other.denominator - other.numerator * denominator,
+                           denominator * other.denominator);
+    }
+
+    // Multiplication operator: Multiplies two fractions
+    BigFraction BigFraction::operator*(const BigFraction &other) const {
+        if (isSmall() && other.isSmall()) {
+            return fromWide(static_cast<int128_t>(numerator.toInt64()) * other.numerator.toInt64(),
+                            static_cast<int128_t>(denominator.toInt64()) * other.denominator.toInt64());
+        }
+        return BigFraction(numerator * other.numerator, denominator * other.denominator);
+    }
+
+    // Division operator: Divides one fraction by another
+    // Throws runtime_error if dividing by zero
+    BigFraction BigFraction::operator/(const BigFraction &other) const {
+        if (other.numerator.sign() == 0) {
+            throw std::runtime_error("Division by zero");
+        }
+        if (isSmall() && other.isSmall()) {
+            int128_t new_numerator = static_cast<int128_t>(numerator.toInt64()) * other.denominator.toInt64();
+            int128_t new_denominator = static_cast<int128_t>(denominator.toInt64()) * other.numerator.toInt64();
+            if (new_denominator < 0) {
+                new_numerator = -new_numerator;
+                new_denominator = -new_denominator;
+            }
+            return fromWide(new_numerator, new_denominator);
+        }
+        return BigFraction(numerator * other.denominator, denominator * other.numerator);
+    }
+
+    BigFraction &BigFraction::operator+=(const BigFraction &other) {
+        *this = *this + other;
+        return *this;
+    }
+
+    BigFraction operator+(float lhs, const BigFraction &rhs) {
+        return rhs + BigFraction(lhs);
+    }
+
+    BigFraction operator-(float lhs, const BigFraction &rhs) {
+        return BigFraction(lhs) - rhs;
+    }
+
+    BigFraction operator*(float lhs, const BigFraction &rhs) {
+        return rhs * BigFraction(lhs);
+    }
+
+    BigFraction operator/(float lhs, const BigFraction &rhs) {
+        return BigFraction(lhs) / rhs;
+    }
+
+    // Three-way comparison operator: Compares two fractions exactly by cross multiplication
+    std::strong_ordering BigFraction::operator<=>(const BigFraction &other) const {
+        if (isSmall() && other.isSmall()) {
+            return static_cast<int128_t>(numerator.toInt64()) * other.denominator.toInt64() <=>
+                   static_cast<int128_t>(other.numerator.toInt64()) * denominator.toInt64();
+        }
+        return numerator * other.denominator <=> other.numerator * denominator;
+    }
+
+    bool BigFraction::operator==(const BigFraction &other) const {
+        // Both fractions are reduced with a positive denominator
+        return numerator == other.numerator && denominator == other.denominator;
+    }
+
+    bool BigFraction::approx_equal(float value, float tolerance) const {
+        return std::abs(numerator.toDouble() / denominator.toDouble() - value) < tolerance;
+    }
+
+    bool operator==(float lhs, const BigFraction &rhs) {
+        return rhs.approx_equal(lhs);
+    }
+
+    bool operator<(float lhs, const BigFraction &rhs) {
+        return BigFraction(lhs) < rhs;
+    }
+
+    bool operator>(float lhs, const BigFraction &rhs) {
+        return rhs < lhs;
+    }
+
+    bool operator<=(float lhs, const BigFraction &rhs) {
+        return !(lhs > rhs);
+    }
+
+    bool operator>=(float lhs, const BigFraction &rhs) {
+        return !(lhs < rhs);
+    }
+
+    BigFraction &BigFraction::operator++() {
+        // Adding the denominator to the numerator keeps the fraction reduced
+        numerator += denominator;
+        return *this;
+    }
+
+    BigFraction BigFraction::operator++(int) {
+        BigFraction temp = *this;
+        numerator += denominator;
+        return temp;
+    }
+
+    BigFraction &BigFraction::operator--() {
+        numerator -= denominator;
+        return *this;
+    }
+
+    BigFraction BigFraction::operator--(int) {
+        BigFraction temp = *this;
+        numerator -= denominator;
+        return temp;
+    }
+
+    std::ostream &operator<<(std::ostream &stream, const BigFraction &fraction) {
+        return stream << fraction.numerator << '/' << fraction.denominator;
+    }
+
+    std::istream &operator>>(std::istream &stream, BigFraction &fraction) {
+        // The fraction is expected as numerator/denominator, the format of operator<<, or as numerator and
+        // denominator separated by whitespace, like the Fraction operator
+        std::string numerator;
+        std::string denominator;
+        if (!(stream >> numerator)) {
+            throw std::runtime_error("Invalid input");
+        }
+        if (std::size_t slash = numerator.find('/'); slash != std::string::npos) {
+            denominator = numerator.substr(slash + 1);
+            numerator.resize(slash);
+        } else if (!(stream >> denominator)) {
+            throw std::runtime_error("Invalid input");
+        }
+        try {
+            BigInteger new_denominator = BigInteger::fromString(denominator);
+            if (new_denominator.sign() == 0) {
+                throw std::runtime_error("Division by Zero");
+            }
+            fraction = BigFraction(BigInteger::fromString(numerator), new_denominator);
+        } catch (const std::invalid_argument &) {
+            stream.setstate(std::ios::failbit);
+            throw std::runtime_error("Invalid input");
+        }
+        return stream;
+    }
+}
@@ -0,0 +1,112 @@
+//
+// Arbitrary precision fraction that never overflows.
+//
+
+#ifndef FRACTION_B_BIGFRACTION_HPP
+#define FRACTION_B_BIGFRACTION_HPP
+
+#include <compare>
+#include <iostream>
+#include <stdexcept>
+
+#include "BigInteger.hpp"
+#include "Fraction.hpp"
+
+namespace ariel {
+    // A fraction with the operator set of Fraction whose numerator and denominator grow as needed.
+    // While both fit in 64 bits they are stored inline and the operators work on 128-bit intermediates;
+    // only a result that outgrows 64 bits switches to heap allocated limbs.
+    class BigFraction {
+    private:
+        BigInteger numerator;   // Stores the numerator of the fraction
+        BigInteger denominator; // Stores the denominator of the fraction
+
+        // Returns true if both numerator and denominator are stored inline
+        bool isSmall() const;
+
+        // Builds a fraction from a 128-bit intermediate result, the denominator must be positive
+        static BigFraction fromWide(int128_t numerator, int128_t denominator);
+
+    public:
+        // Default constructor, creates a fraction with numerator 0 and denominator 1
+        BigFraction();
+
+        // Constructor to initialize fraction with specific numerator and denominator
+        // Throws invalid_argument if denominator is zero
+        BigFraction(BigInteger numerator, BigInteger denominator);
+
+        // Constructor to create a fraction from a floating point number, up to 3 digits beyond the decimal point
+        BigFraction(float value);
+
+        // Lossless conversion from a fixed width fraction
+        template<typename IntT, OverflowPolicy Policy>
+        BigFraction(const BasicFraction<IntT, Policy>& fraction) :
+                numerator(fraction.getNumerator()), denominator(fraction.getDenominator()) {}
+
+        // Lossless conversion to a fixed width fraction, throws overflow_error if the value does not fit
+        template<typename IntT = int>
+        BasicFraction<IntT> toFraction() const {
+            if (!numerator.fitsInt128() || !denominator.fitsInt128()) {
+                throw std::overflow_error("Fraction overflow");
+            }
+            int128_t new_numerator = numerator.toInt128();
+            int128_t new_denominator = denominator.toInt128();
+            if (new_numerator < FractionTraits<IntT>::min() ||
+                new_numerator > FractionTraits<IntT>::max() || new_denominator > FractionTraits<IntT>::max()) {
+                throw std::overflow_error("Fraction overflow");
+            }
+            return BasicFraction<IntT>(static_cast<IntT>(new_numerator), static_cast<IntT>(new_denominator));
+        }
+
+        // Returns the numerator of the fraction
+        const BigInteger& getNumerator() const;
+
+        // Returns the denominator of the fraction
+        const BigInteger& getDenominator() const;
+
+        // Returns true while the fraction is stored without heap allocations
+        bool isInline() const;
+
+        // Reduces the fraction to its simplest form
+        void simplify();
+
+        // Arithmetic operators
+        BigFraction operator+(const BigFraction& other) const; // Addition operator
+        BigFraction operator-(const BigFraction& other) const; // Subtraction operator
+        BigFraction operator*(const BigFraction& other) const; // Multiplication operator
+        BigFraction operator/(const BigFraction& other) const; // Division operator
+        BigFraction& operator+=(const BigFraction& other);     // Addition assignment operator
+
+        // Operator overloads to perform arithmetic with float on the left hand side
+        friend BigFraction operator+(float lhs, const BigFraction& rhs);
+        friend BigFraction operator-(float lhs, const BigFraction& rhs);
+        friend BigFraction operator*(float lhs, const BigFraction& rhs);
+        friend BigFraction operator/(float lhs, const BigFraction& rhs);
+
+        // Comparison operators
+        std::strong_ordering operator<=>(const BigFraction& other) const; // Three-way comparison operator
+        bool operator==(const BigFraction& other) const; // Equality operator
+
+        // Returns true if the fraction differs from the given float by less than the tolerance
+        bool approx_equal(float value, float tolerance = Fraction::FLOAT_TOLERANCE) const;
+
+        // Operator overloads to perform comparison with float on the left hand side
+        friend bool operator==(float lhs, const BigFraction& rhs);
+        friend bool operator<(float lhs, const BigFraction& rhs);
+        friend bool operator>(float lhs, const BigFraction& rhs);
+        friend bool operator<=(float lhs, const BigFraction& rhs);
+        friend bool operator>=(float lhs, const BigFraction& rhs);
+
+        // Increment and decrement operators
+        BigFraction& operator++();    // Prefix increment operator
+        BigFraction operator++(int);  // Postfix increment operator
+        BigFraction& operator--();    // Prefix decrement operator
+        BigFraction operator--(int);  // Postfix decrement operator
+
+        // Stream operators
+        friend std::ostream& operator<<(std::ostream& stream, const BigFraction& frac); // Output stream operator
+        friend std::istream& operator>>(std::istream& stream, BigFraction& frac); // Input stream operator
+    };
+}
+
+#endif //FRACTION_B_BIGFRACTION_HPP
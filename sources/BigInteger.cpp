@@ -0,0 +1,550 @@
+//
+// Arbitrary precision signed integer used by BigFraction.
+//
+#include "BigInteger.hpp"
+#include "Gcd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ariel {
+
+    namespace {
+        using Limb = BigInteger::Limb;
+        using Limbs = BigInteger::Limbs;
+
+        const int LIMB_BITS = 32;
+        const std::uint64_t LIMB_BASE = std::uint64_t{1} << LIMB_BITS;
+        const Limb DECIMAL_CHUNK = 1000000000; // Largest power of 10 that fits in a limb
+        const int DECIMAL_CHUNK_DIGITS = 9;
+
+        // Removes leading zero limbs so that zero is the empty vector
+        void trim(Limbs &magnitude) {
+            while (!magnitude.empty() && magnitude.back() == 0) {
+                magnitude.pop_back();
+            }
+        }
+
+        Limbs magnitudeOf(uint128_t value) {
+            Limbs magnitude;
+            while (value != 0) {
+                magnitude.push_back(static_cast<Limb>(value));
+                value >>= LIMB_BITS;
+            }
+            return magnitude;
+        }
+
+        int compareMagnitude(const Limbs &lhs, const Limbs &rhs) {
+            if (lhs.size() != rhs.size()) {
+                return lhs.size() < rhs.size() ? -1 : 1;
+            }
+            for (std::size_t i = lhs.size(); i-- > 0;) {
+                if (lhs[i] != rhs[i]) {
+                    return lhs[i] < rhs[i] ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+
+        Limbs addMagnitude(const Limbs &lhs, const Limbs &rhs) {
+            const Limbs &longer = lhs.size() >= rhs.size() ? lhs : rhs;
+            const Limbs &shorter = lhs.size() >= rhs.size() ? rhs : lhs;
+            Limbs sum(longer.size() + 1, 0);
+            std::uint64_t carry = 0;
+            for (std::size_t i = 0; i < longer.size(); i++) {
+                carry += longer[i];
+                if (i < shorter.size()) {
+                    carry += shorter[i];
+                }
+                sum[i] = static_cast<Limb>(carry);
+                carry >>= LIMB_BITS;
+            }
+            sum[longer.size()] = static_cast<Limb>(carry);
+            trim(sum);
+            return sum;
+        }
+
+        // Requires lhs >= rhs
+        Limbs subtractMagnitude(const Limbs &lhs, const Limbs &rhs) {
+            Limbs difference(lhs.size(), 0);
+            std::int64_t borrow = 0;
+            for (std::size_t i = 0; i < lhs.size(); i++) {
+                std::int64_t current = static_cast<std::int64_t>(lhs[i]) - borrow;
+                if (i < rhs.size()) {
+                    current -= rhs[i];
+                }
+                borrow = current < 0 ? 1 : 0;
+                difference[i] = static_cast<Limb>(current + borrow * static_cast<std::int64_t>(LIMB_BASE));
+            }
+            trim(difference);
+            return difference;
+        }
+
+        // Schoolbook multiplication
+        Limbs multiplyMagnitude(const Limbs &lhs, const Limbs &rhs) {
+            if (lhs.empty() || rhs.empty()) {
+                return {};
+            }
+            Limbs product(lhs.size() + rhs.size(), 0);
+            for (std::size_t i = 0; i < lhs.size(); i++) {
+                std::uint64_t carry = 0;
+                for (std::size_t j = 0; j < rhs.size(); j++) {
+                    carry += static_cast<std::uint64_t>(lhs[i]) * rhs[j] + product[i + j];
+                    product[i + j] = static_cast<Limb>(carry);
+                    carry >>= LIMB_BITS;
+                }
+                product[i + rhs.size()] = static_cast<Limb>(carry);
+            }
+            trim(product);
+            return product;
+        }
+
+        // Divides in place by a single limb and returns the remainder
+        Limb divideMagnitudeByLimb(Limbs &magnitude, Limb divisor) {
+            std::uint64_t remainder = 0;
+            for (std::size_t i = magnitude.size(); i-- > 0;) {
+                std::uint64_t current = (remainder << LIMB_BITS) | magnitude[i];
+                magnitude[i] = static_cast<Limb>(current / divisor);
+                remainder = current % divisor;
+            }
+            trim(magnitude);
+            return static_cast<Limb>(remainder);
+        }
+
+        Limbs shiftLeftBits(const Limbs &magnitude, unsigned shift, std::size_t extra_limbs) {
+            Limbs shifted(magnitude.size() + extra_limbs, 0);
+            for (std::size_t i = 0; i < magnitude.size(); i++) {
+                std::uint64_t wide = static_cast<std::uint64_t>(magnitude[i]) << shift;
+                shifted[i] |= static_cast<Limb>(wide);
+                if (i + 1 < shifted.size()) {
+                    shifted[i + 1] |= static_cast<Limb>(wide >> LIMB_BITS);
+                }
+            }
+            return shifted;
+        }
+
+        // Long division (Knuth, TAOCP 4.3.1 algorithm D). The divisor must not be zero.
+        void divideMagnitude(const Limbs &dividend, const Limbs &divisor, Limbs &quotient, Limbs &remainder) {
+            if (compareMagnitude(dividend, divisor) < 0) {
+                quotient.clear();
+                remainder = dividend;
+                return;
+            }
+            if (divisor.size() == 1) {
+                quotient = dividend;
+                Limb rest = divideMagnitudeByLimb(quotient, divisor[0]);
+                remainder = rest == 0 ? Limbs{} : Limbs{rest};
+                return;
+            }
+            // Normalize so the top bit of the divisor is set, this keeps every quotient estimate within 2 of the truth
+            auto shift = static_cast<unsigned>(__builtin_clz(divisor.back()));
+            Limbs normalized_divisor = shiftLeftBits(divisor, shift, 0);
+            Limbs normalized_dividend = shiftLeftBits(dividend, shift, 1);
+            std::size_t divisor_size = normalized_divisor.size();
+            std::uint64_t top = normalized_divisor[divisor_size - 1];
+            std::uint64_t second = normalized_divisor[divisor_size - 2];
+            quotient.assign(dividend.size() - divisor_size + 1, 0);
+
+            for (std::size_t j = quotient.size(); j-- > 0;) {
+                std::uint64_t numerator = (static_cast<std::uint64_t>(normalized_dividend[j + divisor_size]) << LIMB_BITS) |
+                                          normalized_dividend[j + divisor_size - 1];
+                std::uint64_t estimate = numerator / top;
+                std::uint64_t rest = numerator % top;
+                while (estimate >= LIMB_BASE ||
+                       estimate * second > ((rest << LIMB_BITS) | normalized_dividend[j + divisor_size - 2])) {
+                    estimate--;
+                    rest += top;
+                    if (rest >= LIMB_BASE) {
+                        break;
+                    }
+                }
+                // Multiply and subtract the estimate times the divisor
+                std::int64_t borrow = 0;
+                std::int64_t current = 0;
+                for (std::size_t i = 0; i < divisor_size; i++) {
+                    std::uint64_t product = estimate * normalized_divisor[i];
+                    current = static_cast<std::int64_t>(normalized_dividend[i + j]) - borrow -
+                              static_cast<std::int64_t>(product & (LIMB_BASE - 1));
+                    normalized_dividend[i + j] = static_cast<Limb>(current);
+                    borrow = static_cast<std::int64_t>(product >> LIMB_BITS) - (current >> LIMB_BITS);
+                }
+                current = static_cast<std::int64_t>(normalized_dividend[j + divisor_size]) - borrow;
+                normalized_dividend[j + divisor_size] = static_cast<Limb>(current);
+                quotient[j] = static_cast<Limb>(estimate);
+                // The estimate was one too large, add the divisor back
+                if (current < 0) {
+                    quotient[j]--;
+                    std::uint64_t carry = 0;
+                    for (std::size_t i = 0; i < divisor_size; i++) {
+                        carry += static_cast<std::uint64_t>(normalized_dividend[i + j]) + normalized_divisor[i];
+                        normalized_dividend[i + j] = static_cast<Limb>(carry);
+                        carry >>= LIMB_BITS;
+                    }
+                    normalized_dividend[j + divisor_size] += static_cast<Limb>(carry);
+                }
+            }
+            trim(quotient);
+            // Undo the normalization on the remainder
+            remainder.assign(divisor_size, 0);
+            for (std::size_t i = 0; i < divisor_size; i++) {
+                std::uint64_t wide = (static_cast<std::uint64_t>(normalized_dividend[i + 1]) << LIMB_BITS) |
+                                     normalized_dividend[i];
+                remainder[i] = static_cast<Limb>(wide >> shift);
+            }
+            trim(remainder);
+        }
+
+        std::size_t bitLengthMagnitude(const Limbs &magnitude) {
+            if (magnitude.empty()) {
+                return 0;
+            }
+            return magnitude.size() * LIMB_BITS - static_cast<std::size_t>(__builtin_clz(magnitude.back()));
+        }
+
+        // Returns magnitude >> shift, the caller guarantees the result has at most 64 bits
+        std::uint64_t bitsFrom(const Limbs &magnitude, std::size_t shift) {
+            std::size_t first = shift / LIMB_BITS;
+            uint128_t window = 0;
+            const std::size_t window_limbs = 3;
+            for (std::size_t i = first + window_limbs; i-- > first;) {
+                window = (window << LIMB_BITS) | (i < magnitude.size() ? magnitude[i] : 0);
+            }
+            return static_cast<std::uint64_t>(window >> (shift % LIMB_BITS));
+        }
+
+        // Computes lhs_factor * lhs + rhs_factor * rhs, the caller guarantees the result is not negative
+        Limbs linearCombination(const Limbs &lhs, std::int64_t lhs_factor, const Limbs &rhs, std::int64_t rhs_factor) {
+            Limbs result(std::max(lhs.size(), rhs.size()), 0);
+            int128_t carry = 0;
+            for (std::size_t i = 0; i < result.size(); i++) {
+                if (i < lhs.size()) {
+                    carry += static_cast<int128_t>(lhs_factor) * lhs[i];
+                }
+                if (i < rhs.size()) {
+                    carry += static_cast<int128_t>(rhs_factor) * rhs[i];
+                }
+                result[i] = static_cast<Limb>(carry);
+                // Arithmetic shift, a negative carry borrows from the next limb
+                carry >>= LIMB_BITS;
+            }
+            trim(result);
+            return result;
+        }
+
+        std::uint64_t toUint64(const Limbs &magnitude) {
+            std::uint64_t value = 0;
+            for (std::size_t i = magnitude.size(); i-- > 0;) {
+                value = (value << LIMB_BITS) | magnitude[i];
+            }
+            return value;
+        }
+    }
+
+    BigInteger::BigInteger() : small(0), negative(false) {}
+
+    BigInteger::BigInteger(int128_t value) : small(0), negative(false) {
+        if (value >= INT64_MIN && value <= INT64_MAX) {
+            small = static_cast<std::int64_t>(value);
+        } else {
+            limbs = magnitudeOf(detail::magnitude128(value));
+            negative = value < 0;
+        }
+    }
+
+    BigInteger BigInteger::fromMagnitude(Limbs magnitude, bool negative) {
+        trim(magnitude);
+        if (magnitude.size() <= 2) {
+            std::uint64_t value = 0;
+            for (std::size_t i = magnitude.size(); i-- > 0;) {
+                value = (value << LIMB_BITS) | magnitude[i];
+            }
+            if (value <= static_cast<std::uint64_t>(INT64_MAX)) {
+                auto small_value = static_cast<std::int64_t>(value);
+                return BigInteger(negative ? -small_value : small_value);
+            }
+            if (negative && value == static_cast<std::uint64_t>(INT64_MAX) + 1) {
+                return BigInteger(INT64_MIN);
+            }
+        }
+        BigInteger result;
+        result.limbs = std::move(magnitude);
+        result.negative = negative;
+        return result;
+    }
+
+    BigInteger::Limbs BigInteger::magnitude() const {
+        if (!isSmall()) {
+            return limbs;
+        }
+        return magnitudeOf(detail::magnitude128(small));
+    }
+
+    BigInteger BigInteger::fromDouble(double value) {
+        if (!std::isfinite(value)) {
+            throw std::invalid_argument("BigInteger from a non finite double");
+        }
+        value = std::trunc(value);
+        if (std::abs(value) < std::ldexp(1.0, LIMB_BITS + LIMB_BITS - 1)) {
+            return BigInteger(static_cast<std::int64_t>(value));
+        }
+        // value = mantissa * 2^exponent with a 53 bit integral mantissa
+        const int mantissa_bits = 53;
+        int exponent = 0;
+        double fraction = std::frexp(std::abs(value), &exponent);
+        auto mantissa = static_cast<std::uint64_t>(std::ldexp(fraction, mantissa_bits));
+        exponent -= mantissa_bits;
+        auto shift = static_cast<std::size_t>(exponent);
+        Limbs magnitude = magnitudeOf(mantissa);
+        magnitude.insert(magnitude.begin(), shift / LIMB_BITS, 0);
+        magnitude = shiftLeftBits(magnitude, static_cast<unsigned>(shift % LIMB_BITS), 1);
+        return fromMagnitude(std::move(magnitude), value < 0);
+    }
+
+    BigInteger BigInteger::fromString(const std::string &text) {
+        bool is_negative = !text.empty() && text[0] == '-';
+        std::size_t first = (is_negative || (!text.empty() && text[0] == '+')) ? 1 : 0;
+        if (first >= text.size()) {
+            throw std::invalid_argument("Invalid number");
+        }
+        Limbs magnitude;
+        for (std::size_t i = first; i < text.size(); i += DECIMAL_CHUNK_DIGITS) {
+            std::size_t end = std::min(text.size(), i + DECIMAL_CHUNK_DIGITS);
+            Limb chunk = 0;
+            Limb scale = 1;
+            for (std::size_t j = i; j < end; j++) {
+                if (text[j] < '0' || text[j] > '9') {
+                    throw std::invalid_argument("Invalid number");
+                }
+                chunk = chunk * 10 + static_cast<Limb>(text[j] - '0');
+                scale *= 10;
+            }
+            // magnitude = magnitude * scale + chunk
+            std::uint64_t carry = chunk;
+            for (Limb &limb: magnitude) {
+                carry += static_cast<std::uint64_t>(limb) * scale;
+                limb = static_cast<Limb>(carry);
+                carry >>= LIMB_BITS;
+            }
+            if (carry != 0) {
+                magnitude.push_back(static_cast<Limb>(carry));
+            }
+        }
+        return fromMagnitude(std::move(magnitude), is_negative);
+    }
+
+    bool BigInteger::isSmall() const {
+        return limbs.empty();
+    }
+
+    int BigInteger::sign() const {
+        if (isSmall()) {
+            return (small > 0) - (small < 0);
+        }
+        return negative ? -1 : 1;
+    }
+
+    bool BigInteger::fitsInt64() const {
+        return isSmall();
+    }
+
+    bool BigInteger::fitsInt128() const {
+        if (isSmall()) {
+            return true;
+        }
+        const std::size_t int128_limbs = 4;
+        if (limbs.size() < int128_limbs) {
+            return true;
+        }
+        if (limbs.size() > int128_limbs) {
+            return false;
+        }
+        // The magnitude may reach 2^127 only for a negative value
+        const Limb top_bit = Limb{1} << (LIMB_BITS - 1);
+        if (limbs.back() < top_bit) {
+            return true;
+        }
+        return negative && limbs.back() == top_bit && limbs[0] == 0 && limbs[1] == 0 && limbs[2] == 0;
+    }
+
+    std::int64_t BigInteger::toInt64() const {
+        if (!isSmall()) {
+            throw std::overflow_error("BigInteger does not fit in 64 bits");
+        }
+        return small;
+    }
+
+    int128_t BigInteger::toInt128() const {
+        if (!fitsInt128()) {
+            throw std::overflow_error("BigInteger does not fit in 128 bits");
+        }
+        if (isSmall()) {
+            return small;
+        }
+        uint128_t value = 0;
+        for (std::size_t i = limbs.size(); i-- > 0;) {
+            value = (value << LIMB_BITS) | limbs[i];
+        }
+        return negative ? static_cast<int128_t>(uint128_t{0} - value) : static_cast<int128_t>(value);
+    }
+
+    double BigInteger::toDouble() const {
+        if (isSmall()) {
+            return static_cast<double>(small);
+        }
+        double value = 0;
+        for (std::size_t i = limbs.size(); i-- > 0;) {
+            value = value * static_cast<double>(LIMB_BASE) + limbs[i];
+        }
+        return negative ? -value : value;
+    }
+
+    std::string BigInteger::toString() const {
+        if (isSmall()) {
+            return std::to_string(small);
+        }
+        std::string digits;
+        Limbs rest = limbs;
+        while (!rest.empty()) {
+            Limb chunk = divideMagnitudeByLimb(rest, DECIMAL_CHUNK);
+            for (int i = 0; i < DECIMAL_CHUNK_DIGITS && (chunk != 0 || !rest.empty()); i++) {
+                digits.push_back(static_cast<char>('0' + chunk % 10));
+                chunk /= 10;
+            }
+        }
+        if (negative) {
+            digits.push_back('-');
+        }
+        std::reverse(digits.begin(), digits.end());
+        return digits;
+    }
+
+    BigInteger BigInteger::gcd(const BigInteger &lhs, const BigInteger &rhs) {
+        if (lhs.isSmall() && rhs.isSmall()) {
+            auto lhs_magnitude = static_cast<std::uint64_t>(detail::magnitude128(lhs.small));
+            auto rhs_magnitude = static_cast<std::uint64_t>(detail::magnitude128(rhs.small));
+            return fromMagnitude(magnitudeOf(binaryGcd(lhs_magnitude, rhs_magnitude)), false);
+        }
+        // Lehmer's algorithm: simulate Euclid on the leading 60 bits and update the full magnitudes
+        // once per batch of steps, until both fit in 64 bits and the binary gcd takes over
+        Limbs a = lhs.magnitude();
+        Limbs b = rhs.magnitude();
+        if (compareMagnitude(a, b) < 0) {
+            std::swap(a, b);
+        }
+        const std::size_t small_limbs = 2;
+        while (!b.empty() && a.size() > small_limbs) {
+            std::size_t shift = bitLengthMagnitude(a) - LEHMER_DIGIT_BITS;
+            LehmerCofactors step = lehmerCofactors(static_cast<std::int64_t>(bitsFrom(a, shift)),
+                                                   static_cast<std::int64_t>(bitsFrom(b, shift)));
+            if (step.b == 0) {
+                Limbs quotient;
+                Limbs remainder;
+                divideMagnitude(a, b, quotient, remainder);
+                a = std::move(b);
+                b = std::move(remainder);
+            } else {
+                Limbs next_a = linearCombination(a, step.a, b, step.b);
+                b = linearCombination(a, step.c, b, step.d);
+                a = std::move(next_a);
+            }
+        }
+        if (b.empty()) {
+            return fromMagnitude(std::move(a), false);
+        }
+        return fromMagnitude(magnitudeOf(binaryGcd(toUint64(a), toUint64(b))), false);
+    }
+
+    BigInteger BigInteger::operator-() const {
+        if (isSmall() && small != INT64_MIN) {
+            return BigInteger(-small);
+        }
+        return fromMagnitude(magnitude(), sign() > 0);
+    }
+
+    BigInteger BigInteger::operator+(const BigInteger &other) const {
+        std::int64_t sum = 0;
+        if (isSmall() && other.isSmall() && !__builtin_add_overflow(small, other.small, &sum)) {
+            return BigInteger(sum);
+        }
+        bool lhs_negative = sign() < 0;
+        bool rhs_negative = other.sign() < 0;
+        Limbs lhs_magnitude = magnitude();
+        Limbs rhs_magnitude = other.magnitude();
+        if (lhs_negative == rhs_negative) {
+            return fromMagnitude(addMagnitude(lhs_magnitude, rhs_magnitude), lhs_negative);
+        }
+        if (compareMagnitude(lhs_magnitude, rhs_magnitude) >= 0) {
+            return fromMagnitude(subtractMagnitude(lhs_magnitude, rhs_magnitude), lhs_negative);
+        }
+        return fromMagnitude(subtractMagnitude(rhs_magnitude, lhs_magnitude), rhs_negative);
+    }
+
+    BigInteger BigInteger::operator-(const BigInteger &other) const {
+        std::int64_t difference = 0;
+        if (isSmall() && other.isSmall() && !__builtin_sub_overflow(small, other.small, &difference)) {
+            return BigInteger(difference);
+        }
+        return *this + (-other);
+    }
+
+    BigInteger BigInteger::operator*(const BigInteger &other) const {
+        if (isSmall() && other.isSmall()) {
+            return BigInteger(static_cast<int128_t>(small) * other.small);
+        }
+        return fromMagnitude(multiplyMagnitude(magnitude(), other.magnitude()), (sign() < 0) != (other.sign() < 0));
+    }
+
+    BigInteger BigInteger::divide(const BigInteger &other, BigInteger &remainder) const {
+        if (other.sign() == 0) {
+            throw std::runtime_error("Division by zero");
+        }
+        // INT64_MIN / -1 is the only inline quotient that does not fit inline
+        if (isSmall() && other.isSmall() && !(small == INT64_MIN && other.small == -1)) {
+            remainder = BigInteger(small % other.small);
+            return BigInteger(small / other.small);
+        }
+        Limbs quotient;
+        Limbs rest;
+        divideMagnitude(magnitude(), other.magnitude(), quotient, rest);
+        remainder = fromMagnitude(std::move(rest), sign() < 0);
+        return fromMagnitude(std::move(quotient), (sign() < 0) != (other.sign() < 0));
+    }
+
+    BigInteger BigInteger::operator/(const BigInteger &other) const {
+        BigInteger remainder;
+        return divide(other, remainder);
+    }
+
+    BigInteger BigInteger::operator%(const BigInteger &other) const {
+        BigInteger remainder;
+        divide(other, remainder);
+        return remainder;
+    }
+
+    BigInteger &BigInteger::operator+=(const BigInteger &other) {
+        *this = *this + other;
+        return *this;
+    }
+
+    BigInteger &BigInteger::operator-=(const BigInteger &other) {
+        *this = *this - other;
+        return *this;
+    }
+
+    std::strong_ordering BigInteger::operator<=>(const BigInteger &other) const {
+        if (isSmall() && other.isSmall()) {
+            return small <=> other.small;
+        }
+        if (sign() != other.sign()) {
+            return sign() <=> other.sign();
+        }
+        int magnitude_order = compareMagnitude(magnitude(), other.magnitude());
+        return sign() < 0 ? 0 <=> magnitude_order : magnitude_order <=> 0;
+    }
+
+    bool BigInteger::operator==(const BigInteger &other) const {
+        // Values are always stored inline when they fit, so equal values have the same representation
+        return small == other.small && negative == other.negative && limbs == other.limbs;
+    }
+}
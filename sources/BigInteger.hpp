@@ -0,0 +1,104 @@
+//
+// Arbitrary precision signed integer used by BigFraction.
+//
+
+#ifndef FRACTION_B_BIGINTEGER_HPP
+#define FRACTION_B_BIGINTEGER_HPP
+
+#include <compare>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "FractionTraits.hpp"
+
+namespace ariel {
+    class BigInteger {
+    public:
+        using Limb = std::uint32_t;
+        using Limbs = std::vector<Limb>;
+
+    private:
+        std::int64_t small; // Stores the value while it fits in 64 bits (limbs is empty)
+        Limbs limbs;        // Magnitude in base 2^32, least significant limb first, once the value outgrew 64 bits
+        bool negative;      // Sign of the value stored in limbs
+
+        // Builds a value from a sign and a magnitude, stores it inline if it fits in 64 bits
+        static BigInteger fromMagnitude(Limbs magnitude, bool negative);
+
+        // Returns the magnitude of the value as limbs, whichever way it is stored
+        Limbs magnitude() const;
+
+    public:
+        // Default constructor, creates the value 0
+        BigInteger();
+
+        // Constructor from any built-in integer, the value is stored inline
+        template<typename IntT, typename = std::enable_if_t<std::is_integral_v<IntT>>>
+        BigInteger(IntT value) : small(static_cast<std::int64_t>(value)), negative(false) {
+            if constexpr (std::is_unsigned_v<IntT> && sizeof(IntT) >= sizeof(std::int64_t)) {
+                if (value > static_cast<std::uint64_t>(INT64_MAX)) {
+                    *this = BigInteger(static_cast<int128_t>(value));
+                }
+            }
+        }
+
+        // Constructor from a 128-bit integer, the value is stored inline if it fits in 64 bits
+        BigInteger(int128_t value);
+
+        // Converts an integral double exactly, throws invalid_argument for infinity and NaN
+        static BigInteger fromDouble(double value);
+
+        // Parses an optionally signed decimal number, throws invalid_argument on malformed input
+        static BigInteger fromString(const std::string& text);
+
+        // Returns true while the value is stored inline without a heap allocation
+        bool isSmall() const;
+
+        // Returns -1, 0 or 1 according to the sign of the value
+        int sign() const;
+
+        // Returns true if the value fits in the given built-in integer type
+        bool fitsInt64() const;
+        bool fitsInt128() const;
+
+        // Returns the value as a built-in integer, throws overflow_error if it does not fit
+        std::int64_t toInt64() const;
+        int128_t toInt128() const;
+
+        // Returns the nearest double, infinity if the value is out of range
+        double toDouble() const;
+
+        // Returns the decimal representation of the value
+        std::string toString() const;
+
+        // Greatest common divisor, always non negative
+        static BigInteger gcd(const BigInteger& lhs, const BigInteger& rhs);
+
+        // Arithmetic operators, division truncates toward zero like the built-in operators
+        BigInteger operator-() const;
+        BigInteger operator+(const BigInteger& other) const;
+        BigInteger operator-(const BigInteger& other) const;
+        BigInteger operator*(const BigInteger& other) const;
+        BigInteger operator/(const BigInteger& other) const;
+        BigInteger operator%(const BigInteger& other) const;
+        BigInteger& operator+=(const BigInteger& other);
+        BigInteger& operator-=(const BigInteger& other);
+
+        // Divides by other, returns the quotient and stores the remainder, throws runtime_error on zero
+        BigInteger divide(const BigInteger& other, BigInteger& remainder) const;
+
+        // Comparison operators
+        std::strong_ordering operator<=>(const BigInteger& other) const;
+        bool operator==(const BigInteger& other) const;
+
+        // Output stream operator, writes the value in decimal
+        friend std::ostream& operator<<(std::ostream& stream, const BigInteger& value) {
+            return stream << value.toString();
+        }
+    };
+}
+
+#endif //FRACTION_B_BIGINTEGER_HPP
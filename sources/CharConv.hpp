@@ -0,0 +1,124 @@
+//
+// Locale independent integer formatting and parsing used by the fraction text conversions.
+//
+
+#ifndef FRACTION_B_CHARCONV_HPP
+#define FRACTION_B_CHARCONV_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <istream>
+#include <iterator>
+#include <system_error>
+
+#include "Gcd.hpp"
+
+namespace ariel::detail {
+    // Upper bound on the decimal digits of a value with the given number of bits, ceil(bits * log10(2))
+    constexpr std::size_t maxDecimalDigits(std::size_t bits) {
+        const std::size_t scale = 100000;
+        const std::size_t log10_of_two = 30103; // log10(2) * scale
+        return (bits * log10_of_two + scale - 1) / scale;
+    }
+
+    // Writes a signed integer in decimal like std::to_chars, which has no 128-bit overload
+    template<typename IntT>
+    std::to_chars_result formatInteger(char *first, char *last, IntT value) {
+        if constexpr (sizeof(IntT) <= sizeof(long long)) {
+            return std::to_chars(first, last, value);
+        } else {
+            const unsigned base = 10;
+            char digits[maxDecimalDigits(sizeof(IntT) * 8)];
+            char *start = std::end(digits);
+            uint128_t rest = value < 0 ? uint128_t{0} - static_cast<uint128_t>(value) : static_cast<uint128_t>(value);
+            do {
+                *--start = static_cast<char>('0' + static_cast<int>(rest % base));
+                rest /= base;
+            } while (rest != 0);
+            auto length = static_cast<std::size_t>(std::end(digits) - start) + (value < 0 ? 1 : 0);
+            if (static_cast<std::size_t>(last - first) < length) {
+                return {last, std::errc::value_too_large};
+            }
+            if (value < 0) {
+                *first++ = '-';
+            }
+            char *next = std::copy(start, std::end(digits), first);
+            return {next, std::errc{}};
+        }
+    }
+
+    // Parses an optional minus sign and the decimal digits of the magnitude like std::from_chars.
+    // The magnitude is returned unsigned so that the caller decides which range it accepts.
+    template<typename UIntT>
+    std::from_chars_result parseSigned(const char *first, const char *last, bool &negative, UIntT &magnitude) {
+        const char *next = first;
+        negative = next != last && *next == '-';
+        if (negative) {
+            ++next;
+        }
+        if constexpr (sizeof(UIntT) <= sizeof(unsigned long long)) {
+            std::from_chars_result result = std::from_chars(next, last, magnitude);
+            if (result.ec == std::errc::invalid_argument) {
+                result.ptr = first;
+            }
+            return result;
+        } else {
+            const UIntT base = 10;
+            const char *digits = next;
+            UIntT value = 0;
+            bool overflow = false;
+            for (; next != last && *next >= '0' && *next <= '9'; ++next) {
+                auto digit = static_cast<UIntT>(*next - '0');
+                overflow = overflow || __builtin_mul_overflow(value, base, &value) ||
+                           __builtin_add_overflow(value, digit, &value);
+            }
+            if (next == digits) {
+                return {first, std::errc::invalid_argument};
+            }
+            if (overflow) {
+                return {next, std::errc::result_out_of_range};
+            }
+            magnitude = value;
+            return {next, std::errc{}};
+        }
+    }
+
+    // Whitespace of the "C" locale, the stream locale is not consulted
+    inline bool isSpace(int character) {
+        return character == ' ' || (character >= '\t' && character <= '\r');
+    }
+
+    // Reads the next whitespace delimited token of the stream into [first, last) without allocating.
+    // Returns the end of the token, or nullptr with failbit set if there is none or it does not fit.
+    inline char *readToken(std::istream &stream, char *first, char *last) {
+        std::istream::sentry sentry(stream);
+        if (!sentry) {
+            return nullptr;
+        }
+        std::streambuf *buffer = stream.rdbuf();
+        char *next = first;
+        while (true) {
+            int character = buffer->sgetc();
+            if (character == std::char_traits<char>::eof()) {
+                stream.setstate(std::ios::eofbit);
+                break;
+            }
+            if (isSpace(character)) {
+                break;
+            }
+            if (next == last) {
+                stream.setstate(std::ios::failbit);
+                return nullptr;
+            }
+            *next++ = static_cast<char>(character);
+            buffer->sbumpc();
+        }
+        if (next == first) {
+            stream.setstate(std::ios::failbit);
+            return nullptr;
+        }
+        return next;
+    }
+}
+
+#endif //FRACTION_B_CHARCONV_HPP
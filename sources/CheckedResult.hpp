@@ -0,0 +1,71 @@
+//
+// Status carrying results of the exception free fraction operations.
+//
+
+#ifndef FRACTION_B_CHECKEDRESULT_HPP
+#define FRACTION_B_CHECKEDRESULT_HPP
+
+#include <stdexcept>
+
+#include "FractionStats.hpp"
+
+namespace ariel {
+    // Why a checked operation failed, each error corresponds to the exception the operators throw
+    enum class FractionError {
+        None,            // The operation succeeded
+        Overflow,        // The reduced result does not fit, overflow_error
+        ZeroDenominator, // A fraction was created with a zero denominator, invalid_argument
+        DivisionByZero   // The divisor was zero, runtime_error
+    };
+
+    // Throws the exception the throwing API uses for the given error
+    constexpr void throwFractionError(FractionError error) {
+        switch (error) {
+            case FractionError::None:
+                return;
+            case FractionError::Overflow:
+                detail::countStat(StatCounter::OverflowErrors);
+                throw std::overflow_error("Fraction overflow");
+            case FractionError::ZeroDenominator:
+                throw std::invalid_argument("Division by zero");
+            case FractionError::DivisionByZero:
+                throw std::runtime_error("Division by zero");
+        }
+    }
+
+    // Either a value or the error that prevented computing it, like C++23 std::expected<T, FractionError>.
+    // Nothing in it throws except value(), which is how the throwing operators are built on the checked ones.
+    template<typename T>
+    class CheckedResult {
+    private:
+        T result;             // The value, default constructed on error
+        FractionError status; // None if result holds the value
+
+    public:
+        constexpr CheckedResult(const T& value) : result(value), status(FractionError::None) {}
+
+        // The error must not be None
+        constexpr CheckedResult(FractionError error) : result(), status(error) {}
+
+        constexpr bool has_value() const { return status == FractionError::None; }
+
+        constexpr explicit operator bool() const { return has_value(); }
+
+        constexpr FractionError error() const { return status; }
+
+        // Returns the value, throws the exception matching the error if there is none
+        constexpr const T& value() const {
+            throwFractionError(status);
+            return result;
+        }
+
+        // Returns the value without checking, only valid if has_value()
+        constexpr const T& operator*() const { return result; }
+
+        constexpr const T* operator->() const { return &result; }
+
+        constexpr T value_or(const T& fallback) const { return has_value() ? result : fallback; }
+    };
+}
+
+#endif //FRACTION_B_CHECKEDRESULT_HPP
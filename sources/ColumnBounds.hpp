@@ -0,0 +1,26 @@
+//
+// Range checks for int columns read from outside the library.
+//
+
+#ifndef FRACTION_B_COLUMNBOUNDS_HPP
+#define FRACTION_B_COLUMNBOUNDS_HPP
+
+#include <algorithm>
+#include <limits>
+#include <span>
+
+namespace ariel::detail {
+    // Whether every value of the column lies in [minimum, maximum]. Tracking the smallest and largest value
+    // rather than exiting early keeps the loop vectorized.
+    inline bool withinBounds(std::span<const int> column, int minimum, int maximum) {
+        int smallest = std::numeric_limits<int>::max();
+        int largest = std::numeric_limits<int>::min();
+        for (int value: column) {
+            smallest = std::min(smallest, value);
+            largest = std::max(largest, value);
+        }
+        return smallest >= minimum && largest <= maximum;
+    }
+}
+
+#endif //FRACTION_B_COLUMNBOUNDS_HPP
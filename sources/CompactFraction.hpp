@@ -0,0 +1,137 @@
+//
+// Fractions with small terms packed into 32 bits, for large in-memory tables.
+//
+
+#ifndef FRACTION_B_COMPACTFRACTION_HPP
+#define FRACTION_B_COMPACTFRACTION_HPP
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "Fraction.hpp"
+
+namespace ariel {
+    // A reduced fraction with a signed 16-bit numerator and an unsigned 16-bit denominator packed into one
+    // uint32_t: the numerator in the low half, the denominator in the high half. It is a storage type, the
+    // arithmetic is done on Fraction. Since the stored fraction is reduced, equal values have equal bits.
+    class CompactFraction {
+    private:
+        static constexpr unsigned HALF_BITS = 16;
+        static constexpr std::uint32_t HALF_MASK = 0xffff;
+
+        std::uint32_t packed; // Denominator << 16 | numerator
+
+        static constexpr std::uint32_t pack(int numerator, int denominator) {
+            return static_cast<std::uint32_t>(denominator) << HALF_BITS |
+                   (static_cast<std::uint32_t>(numerator) & HALF_MASK);
+        }
+
+    public:
+        // Largest denominator that fits
+        static constexpr int MAX_DENOMINATOR = std::numeric_limits<std::uint16_t>::max();
+
+        // Creates 0/1
+        constexpr CompactFraction() : packed(pack(0, 1)) {}
+
+        // Packs a fraction, throws overflow_error if the numerator does not fit in 16 signed bits or the
+        // denominator in 16 unsigned bits
+        explicit constexpr CompactFraction(const Fraction& fraction) : CompactFraction(try_from(fraction).value()) {}
+
+        // Same as the constructor, but returns Overflow instead of throwing
+        static constexpr CheckedResult<CompactFraction> try_from(const Fraction& fraction) {
+            int numerator = fraction.getNumerator();
+            int denominator = fraction.getDenominator();
+            if (numerator < std::numeric_limits<std::int16_t>::min() ||
+                numerator > std::numeric_limits<std::int16_t>::max() || denominator > MAX_DENOMINATOR) {
+                return FractionError::Overflow;
+            }
+            return fromBits(pack(numerator, denominator));
+        }
+
+        // Rebuilds a value from bits(), which must come from a valid CompactFraction
+        static constexpr CompactFraction fromBits(std::uint32_t bits) {
+            CompactFraction result;
+            result.packed = bits;
+            return result;
+        }
+
+        constexpr std::uint32_t bits() const { return packed; }
+
+        constexpr int getNumerator() const { return static_cast<std::int16_t>(packed & HALF_MASK); }
+
+        constexpr int getDenominator() const { return static_cast<int>(packed >> HALF_BITS); }
+
+        // Unpacks the value, never fails. The packed terms are reduced with a positive denominator, so they are
+        // copied without another gcd.
+        constexpr Fraction toFraction() const {
+            return Fraction(Fraction::ReducedTerms{}, getNumerator(), getDenominator());
+        }
+
+        constexpr bool operator==(const CompactFraction& other) const { return packed == other.packed; }
+
+        // Both cross products are below 2^31, so the comparison needs no wider type
+        constexpr std::strong_ordering operator<=>(const CompactFraction& other) const {
+            return getNumerator() * other.getDenominator() <=> other.getNumerator() * getDenominator();
+        }
+    };
+
+    // A sequence of fractions stored as CompactFraction, half the size of a std::vector<Fraction>.
+    // Elements are read and written as Fraction; writing a value that does not fit throws overflow_error.
+    class CompactFractionVector {
+    private:
+        std::vector<CompactFraction> values;
+
+    public:
+        CompactFractionVector() = default;
+
+        // Creates a vector of size zeros (0/1)
+        explicit CompactFractionVector(std::size_t size) : values(size) {}
+
+        CompactFractionVector(std::initializer_list<Fraction> fractions) {
+            values.reserve(fractions.size());
+            for (const Fraction& fraction: fractions) {
+                push_back(fraction);
+            }
+        }
+
+        explicit CompactFractionVector(const std::vector<Fraction>& fractions) {
+            values.reserve(fractions.size());
+            for (const Fraction& fraction: fractions) {
+                push_back(fraction);
+            }
+        }
+
+        std::size_t size() const { return values.size(); }
+
+        bool empty() const { return values.empty(); }
+
+        void reserve(std::size_t capacity) { values.reserve(capacity); }
+
+        void clear() { values.clear(); }
+
+        // Resizes the vector, new elements are zeros (0/1)
+        void resize(std::size_t size) { values.resize(size); }
+
+        void push_back(const Fraction& fraction) { values.emplace_back(fraction); }
+
+        // Returns the element at the given index as a Fraction
+        Fraction operator[](std::size_t index) const { return values[index].toFraction(); }
+
+        // Stores a Fraction at the given index
+        void set(std::size_t index, const Fraction& fraction) { values[index] = CompactFraction(fraction); }
+
+        // Direct access to the packed elements
+        const CompactFraction* data() const { return values.data(); }
+
+        const CompactFraction* begin() const { return values.data(); }
+
+        const CompactFraction* end() const { return values.data() + values.size(); }
+    };
+}
+
+#endif //FRACTION_B_COMPACTFRACTION_HPP
@@ -0,0 +1,227 @@
+//
+// Conversions from binary floating point values to rationals.
+//
+
+#ifndef FRACTION_B_FLOATCONVERSION_HPP
+#define FRACTION_B_FLOATCONVERSION_HPP
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include "Gcd.hpp"
+
+namespace ariel::detail {
+    // A non negative rational with 128-bit terms, a zero denominator stands for infinity
+    struct UnsignedRatio {
+        uint128_t numerator;
+        uint128_t denominator;
+    };
+
+    // A finite double split into sign, odd mantissa and binary exponent: mantissa * 2^exponent
+    struct DecodedDouble {
+        bool negative;
+        std::uint64_t mantissa;
+        int exponent;
+    };
+
+    // Largest power of two used as a denominator, leaves headroom for the continued fraction steps
+    const int MAX_RATIO_SHIFT = 125;
+
+    // Decodes the IEEE 754 fields of a double, throws invalid_argument for infinity and NaN
+    inline DecodedDouble decodeDouble(double value) {
+        const int mantissa_bits = 52;
+        const int exponent_bias = 1075; // 1023 plus the mantissa bits, the mantissa is read as an integer
+        const std::uint64_t exponent_mask = 0x7ff;
+        const int sign_shift = 63;
+        auto bits = std::bit_cast<std::uint64_t>(value);
+        auto biased = static_cast<int>((bits >> mantissa_bits) & exponent_mask);
+        if (biased == static_cast<int>(exponent_mask)) {
+            throw std::invalid_argument("Not a finite number");
+        }
+        DecodedDouble result{(bits >> sign_shift) != 0,
+                             bits & ((std::uint64_t{1} << mantissa_bits) - 1), 1 - exponent_bias};
+        if (biased != 0) {
+            // Normal numbers have an implicit leading one, subnormals share the smallest exponent
+            result.mantissa |= std::uint64_t{1} << mantissa_bits;
+            result.exponent = biased - exponent_bias;
+        }
+        if (result.mantissa == 0) {
+            result.exponent = 0;
+        } else {
+            int zeros = countTrailingZeros(result.mantissa);
+            result.mantissa >>= zeros;
+            result.exponent += zeros;
+        }
+        return result;
+    }
+
+    // The exact magnitude of a decoded double as a dyadic ratio.
+    // Returns false if it needs more than 127 bits or a denominator above 2^125.
+    inline bool exactRatio(const DecodedDouble &value, UnsignedRatio &result) {
+        const int max_bits = 127;
+        if (value.exponent >= 0) {
+            if (value.mantissa != 0 && bitLength(value.mantissa) + value.exponent > max_bits) {
+                return false;
+            }
+            result = {static_cast<uint128_t>(value.mantissa) << value.exponent, 1};
+            return true;
+        }
+        if (-value.exponent > MAX_RATIO_SHIFT) {
+            return false;
+        }
+        result = {value.mantissa, uint128_t{1} << -value.exponent};
+        return true;
+    }
+
+    // Like exactRatio, but values too small for a 2^125 denominator are truncated to it.
+    // Throws overflow_error for values of 2^127 and above.
+    inline UnsignedRatio toRatio(const DecodedDouble &value) {
+        UnsignedRatio result{0, 1};
+        if (exactRatio(value, result)) {
+            return result;
+        }
+        if (value.exponent >= 0) {
+            throw std::overflow_error("Fraction overflow");
+        }
+        int shift = -value.exponent - MAX_RATIO_SHIFT;
+        std::uint64_t mantissa = shift < static_cast<int>(sizeof(mantissa) * 8) ? value.mantissa >> shift : 0;
+        return {mantissa, uint128_t{1} << MAX_RATIO_SHIFT};
+    }
+
+    // Compares lhs1 * lhs2 with rhs1 * rhs2, the products are formed in 128 bits
+    inline std::strong_ordering compareProducts(std::uint64_t lhs1, std::uint64_t lhs2,
+                                                std::uint64_t rhs1, std::uint64_t rhs2) {
+        return static_cast<uint128_t>(lhs1) * lhs2 <=> static_cast<uint128_t>(rhs1) * rhs2;
+    }
+
+    // Compares lhs1 * lhs2 with rhs1 * rhs2 using 256-bit products
+    inline std::strong_ordering compareProducts(uint128_t lhs1, uint128_t lhs2, uint128_t rhs1, uint128_t rhs2) {
+        const unsigned half = 64;
+        const uint128_t low_mask = ~std::uint64_t{0};
+        auto multiply = [&](uint128_t lhs, uint128_t rhs, uint128_t &high, uint128_t &low) {
+            uint128_t low_low = (lhs & low_mask) * (rhs & low_mask);
+            uint128_t low_high = (lhs & low_mask) * (rhs >> half);
+            uint128_t high_low = (lhs >> half) * (rhs & low_mask);
+            uint128_t middle = (low_low >> half) + (low_high & low_mask) + (high_low & low_mask);
+            low = (middle << half) | (low_low & low_mask);
+            high = (lhs >> half) * (rhs >> half) + (low_high >> half) + (high_low >> half) + (middle >> half);
+        };
+        uint128_t lhs_high = 0;
+        uint128_t lhs_low = 0;
+        uint128_t rhs_high = 0;
+        uint128_t rhs_low = 0;
+        multiply(lhs1, lhs2, lhs_high, lhs_low);
+        multiply(rhs1, rhs2, rhs_high, rhs_low);
+        return lhs_high != rhs_high ? lhs_high <=> rhs_high : lhs_low <=> rhs_low;
+    }
+
+    // Continued fraction loop of bestApproximation in the unsigned type UIntT
+    template<typename UIntT>
+    UnsignedRatio bestApproximationIn(UIntT n, UIntT d, UIntT max_numerator, UIntT max_denominator) {
+        // Previous and current convergents, value = (p1 * n + p0 * d) / (q1 * n + q0 * d) throughout
+        UIntT p0 = 0;
+        UIntT q0 = 1;
+        UIntT p1 = 1;
+        UIntT q1 = 0;
+        while (d != 0) {
+            UIntT quotient = n / d;
+            UIntT next_p = 0;
+            UIntT next_q = 0;
+            if (__builtin_mul_overflow(quotient, p1, &next_p) || __builtin_add_overflow(next_p, p0, &next_p) ||
+                __builtin_mul_overflow(quotient, q1, &next_q) || __builtin_add_overflow(next_q, q0, &next_q) ||
+                next_p > max_numerator || next_q > max_denominator) {
+                if (q1 == 0) {
+                    return {0, 0};
+                }
+                // The largest term for which the semiconvergent still fits the bounds
+                UIntT limit = (max_denominator - q0) / q1;
+                if (p1 != 0) {
+                    limit = std::min(limit, static_cast<UIntT>((max_numerator - p0) / p1));
+                }
+                // The semiconvergent is off by (n - limit * d) / ((q0 + limit * q1) * D) and the
+                // convergent by d / (q1 * D), D being the same for both
+                UIntT semi_denominator = q0 + limit * q1;
+                if (limit != 0 && compareProducts(n - limit * d, q1, d, semi_denominator) < 0) {
+                    return {p0 + limit * p1, semi_denominator};
+                }
+                return {p1, q1};
+            }
+            p0 = p1;
+            p1 = next_p;
+            q0 = q1;
+            q1 = next_q;
+            UIntT rest = n - quotient * d;
+            n = d;
+            d = rest;
+        }
+        return {p1, q1};
+    }
+
+    // Best rational approximation of value with terms bounded by max_numerator and max_denominator
+    // (both at least 1): the closest such fraction, the one with the smaller denominator on a tie.
+    // It is either the last convergent of the continued fraction of value that fits the bounds, or
+    // the largest semiconvergent between that convergent and the next one. The result is reduced;
+    // its denominator is 0 if even the integer part of value exceeds max_numerator.
+    inline UnsignedRatio bestApproximation(UnsignedRatio value, uint128_t max_numerator, uint128_t max_denominator) {
+        // No term of the expansion exceeds the terms of value, so 64-bit values need 64-bit arithmetic only
+        const uint128_t narrow_max = ~std::uint64_t{0};
+        if (value.numerator <= narrow_max && value.denominator <= narrow_max) {
+            return bestApproximationIn<std::uint64_t>(static_cast<std::uint64_t>(value.numerator),
+                                                      static_cast<std::uint64_t>(value.denominator),
+                                                      static_cast<std::uint64_t>(std::min(max_numerator, narrow_max)),
+                                                      static_cast<std::uint64_t>(std::min(max_denominator, narrow_max)));
+        }
+        return bestApproximationIn<uint128_t>(value.numerator, value.denominator, max_numerator, max_denominator);
+    }
+
+    // Continued fraction loop of simplestBetween in the unsigned type UIntT, a zero upper_denominator
+    // stands for infinity
+    template<typename UIntT>
+    UnsignedRatio simplestBetweenIn(UIntT lower_numerator, UIntT lower_denominator,
+                                    UIntT upper_numerator, UIntT upper_denominator) {
+        UIntT p0 = 0;
+        UIntT q0 = 1;
+        UIntT p1 = 1;
+        UIntT q1 = 0;
+        while (true) {
+            UIntT whole = lower_numerator / lower_denominator;
+            if (upper_denominator == 0 || (whole + 1) * upper_denominator < upper_numerator) {
+                return {p0 + (whole + 1) * p1, q0 + (whole + 1) * q1};
+            }
+            UIntT next = p0 + whole * p1;
+            p0 = p1;
+            p1 = next;
+            next = q0 + whole * q1;
+            q0 = q1;
+            q1 = next;
+            // Continue with the reciprocals of the fractional parts, which swaps the bounds
+            UIntT next_numerator = upper_denominator;
+            UIntT next_denominator = upper_numerator - whole * upper_denominator;
+            upper_numerator = lower_denominator;
+            upper_denominator = lower_numerator - whole * lower_denominator;
+            lower_numerator = next_numerator;
+            lower_denominator = next_denominator;
+        }
+    }
+
+    // The fraction with the smallest terms strictly between lower and upper, 0 <= lower < upper.
+    // Both bounds are expanded as continued fractions while they share the same integer part, the
+    // first integer strictly inside the remaining interval ends the expansion.
+    inline UnsignedRatio simplestBetween(UnsignedRatio lower, UnsignedRatio upper) {
+        // (whole + 1) * upper_denominator stays below twice the largest term
+        const uint128_t narrow_max = std::numeric_limits<std::int64_t>::max();
+        if (lower.numerator <= narrow_max && lower.denominator <= narrow_max &&
+            upper.numerator <= narrow_max && upper.denominator <= narrow_max) {
+            return simplestBetweenIn<std::uint64_t>(
+                    static_cast<std::uint64_t>(lower.numerator), static_cast<std::uint64_t>(lower.denominator),
+                    static_cast<std::uint64_t>(upper.numerator), static_cast<std::uint64_t>(upper.denominator));
+        }
+        return simplestBetweenIn<uint128_t>(lower.numerator, lower.denominator, upper.numerator, upper.denominator);
+    }
+}
+
+#endif //FRACTION_B_FLOATCONVERSION_HPP
@@ -5,70 +5,907 @@
 #ifndef FRACTION_B_FRACTION_HPP
 #define FRACTION_B_FRACTION_HPP
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <compare>
+#include <functional>
 #include <iostream>
+#include <stdexcept>
+
+#include "CharConv.hpp"
+#include "CheckedResult.hpp"
+#include "FloatConversion.hpp"
+#include "FractionStats.hpp"
+#include "FractionTraits.hpp"
+#include "Hash.hpp"
 
 namespace ariel {
-    class Fraction {
+    // What the arithmetic operators do when a reduced result does not fit in the integer type
+    enum class OverflowPolicy {
+        Throw,     // Throw overflow_error, the default
+        Saturate,  // Return the closest representable fraction, the minimum or maximum if the value is too large
+        Promote,   // Return the exact result as a fraction of the next wider type, which can't overflow.
+                   // 128-bit fractions have no wider type and throw like Throw.
+        Unchecked  // Wrap around like unsigned arithmetic, without checks; the result is meaningless on overflow
+    };
+
+    namespace detail {
+        // Counts the term sizes of a fraction in the histograms and returns it, see FractionStats.hpp
+        template<typename FractionT>
+        constexpr FractionT countTerms(FractionT value) {
+            if constexpr (STATS_ENABLED) {
+                countTermBits(bitLength(magnitude128(value.getNumerator())),
+                              bitLength(static_cast<uint128_t>(value.getDenominator())));
+            }
+            return value;
+        }
+    }
+
+    template<typename IntT, OverflowPolicy Policy = OverflowPolicy::Throw>
+    class BasicFraction {
     private:
-        int numerator;   // Stores the numerator of the fraction
-        int denominator; // Stores the denominator of the fraction
+        using Traits = FractionTraits<IntT>;
+        using WideT = typename Traits::wide_type;
+        using UnsignedWideT = typename Traits::unsigned_wide_type;
+
+        static_assert(Traits::has_wide_type || Policy != OverflowPolicy::Saturate,
+                      "Saturate needs a wider type to compute the exact result");
+
+        IntT numerator;   // Stores the numerator of the fraction
+        IntT denominator; // Stores the denominator of the fraction
+
+        // Selects the constructor that stores terms as they are
+        struct ReducedTerms {};
+
+        // Stores terms that are already reduced with a positive denominator, without a gcd or any check.
+        // For the packed storage types, whose bits can only hold such terms.
+        constexpr BasicFraction(ReducedTerms, IntT numerator, IntT denominator)
+                : numerator(numerator), denominator(denominator) {}
+
+        friend class CompactFraction;
+
+        // Reduces a wide intermediate result, fails with Overflow if it does not fit in IntT
+        static constexpr CheckedResult<BasicFraction> fromWide(WideT numerator, WideT denominator);
+
+        // Multiplies two reduced fractions with cross-cancellation, see checked_mul
+        static constexpr CheckedResult<BasicFraction> multiplyReduced(IntT lhs_numerator, IntT lhs_denominator,
+                                                                      IntT rhs_numerator, IntT rhs_denominator);
+
+        // Adds (or subtracts) two fractions without a wider type, used by the 128-bit width
+        static constexpr CheckedResult<BasicFraction> addChecked(const BasicFraction& lhs, const BasicFraction& rhs,
+                                                                 bool subtract);
+
+        // Adds or subtracts two fractions, see checked_add
+        static constexpr CheckedResult<BasicFraction> addReduced(const BasicFraction& lhs, const BasicFraction& rhs,
+                                                                 bool subtract);
+
+        // Exact three-way comparison of two fractions without a wider type, used by the 128-bit width
+        static constexpr std::strong_ordering compareChecked(const BasicFraction& lhs, const BasicFraction& rhs);
+
+        // Builds a fraction from a reduced magnitude, returns false if it does not fit in IntT
+        static bool tryFromRatio(bool negative, detail::UnsignedRatio ratio, BasicFraction& result);
+
+        // Same as tryFromRatio, throws overflow_error if the fraction does not fit in IntT
+        static BasicFraction fromRatio(bool negative, detail::UnsignedRatio ratio);
+
+        // The arithmetic operations, for the code shared by all operators
+        enum class Operation { Add, Subtract, Multiply, Divide };
+
+        // The checked_* function of an operation
+        static constexpr CheckedResult<BasicFraction> checkedOperation(const BasicFraction& lhs, const BasicFraction& rhs,
+                                                                       Operation operation);
+
+        // The unreduced result of an operation as a wide numerator and a non negative denominator, computed
+        // with wrapping arithmetic. Only 128-bit values can wrap, narrower widths give the exact result.
+        static constexpr std::pair<UnsignedWideT, UnsignedWideT> wideResult(const BasicFraction& lhs,
+                                                                            const BasicFraction& rhs,
+                                                                            Operation operation);
+
+        // Computes an operation the way the overflow policy asks for
+        static constexpr auto withPolicy(const BasicFraction& lhs, const BasicFraction& rhs, Operation operation);
+
+        template<typename T, OverflowPolicy P>
+        friend std::from_chars_result from_chars(const char* first, const char* last, BasicFraction<T, P>& value);
+
+        template<typename T, OverflowPolicy P>
+        friend constexpr CheckedResult<BasicFraction<T, P>> checked_add(const BasicFraction<T, P>& lhs,
+                                                                     const BasicFraction<T, P>& rhs);
+
+        template<typename T, OverflowPolicy P>
+        friend constexpr CheckedResult<BasicFraction<T, P>> checked_sub(const BasicFraction<T, P>& lhs,
+                                                                     const BasicFraction<T, P>& rhs);
+
+        template<typename T, OverflowPolicy P>
+        friend constexpr CheckedResult<BasicFraction<T, P>> checked_mul(const BasicFraction<T, P>& lhs,
+                                                                     const BasicFraction<T, P>& rhs);
+
+        template<typename T, OverflowPolicy P>
+        friend constexpr CheckedResult<BasicFraction<T, P>> checked_div(const BasicFraction<T, P>& lhs,
+                                                                     const BasicFraction<T, P>& rhs);
 
     public:
+        // Type returned by the arithmetic operators, the next wider fraction under OverflowPolicy::Promote
+        using arithmetic_type = std::conditional_t<Policy == OverflowPolicy::Promote && Traits::has_wide_type,
+                                                   BasicFraction<WideT, Policy>, BasicFraction>;
+
         // Default constructor, creates a fraction with numerator 0 and denominator 1
-        Fraction();
+        constexpr BasicFraction();
+
+        // Converts a fraction of the same or a narrower width, or with another policy, without loss
+        template<typename OtherIntT, OverflowPolicy OtherPolicy>
+        requires (sizeof(OtherIntT) <= sizeof(IntT))
+        constexpr BasicFraction(const BasicFraction<OtherIntT, OtherPolicy>& other)
+                : numerator(other.getNumerator()), denominator(other.getDenominator()) {}
 
         // Constructor to initialize fraction with specific numerator and denominator
-        Fraction(int numerator, int denominator);
+        // Throws invalid_argument if the denominator is zero and overflow_error if the reduced fraction
+        // can't have a positive denominator
+        constexpr BasicFraction(IntT numerator, IntT denominator);
 
-        // Constructor to create a fraction from a floating point number
-        Fraction(float value);
+        // Same as the constructor, but returns ZeroDenominator or Overflow instead of throwing
+        static constexpr CheckedResult<BasicFraction> try_make(IntT numerator, IntT denominator);
+
+        // Constructor to create a fraction from a floating point number, up to 3 digits beyond the decimal point
+        BasicFraction(float value);
+
+        // Best rational approximation of a double: the closest fraction whose denominator does not exceed
+        // max_denominator. Throws invalid_argument for infinity, NaN or a bound below 1 and overflow_error
+        // if the value is out of range.
+        static BasicFraction from_double(double value, IntT max_denominator = FractionTraits<IntT>::max());
+
+        // The simplest fraction that rounds to the given float, so 0.1F gives 1/10. Falls back to the best
+        // approximation if that fraction needs a denominator above max_denominator.
+        static BasicFraction from_float(float value, IntT max_denominator = FractionTraits<IntT>::max());
+
+        // The exact value of a double as a dyadic fraction, throws overflow_error if it does not fit in IntT
+        static BasicFraction from_double_exact(double value);
 
         // Returns the numerator of the fraction
-        int getNumerator() const;
+        constexpr IntT getNumerator() const;
 
         // Returns the denominator of the fraction
-        int getDenominator() const;
+        constexpr IntT getDenominator() const;
 
         // Reduces the fraction to its simplest form
-        void simplify();
+        constexpr void simplify();
 
-        // Arithmetic operators
-        Fraction operator+(const Fraction& other) const; // Addition operator
-        Fraction operator-(const Fraction& other) const; // Subtraction operator
-        Fraction operator*(const Fraction& other) const; // Multiplication operator
-        Fraction operator/(const Fraction& other) const; // Division operator
+        // Arithmetic operators. On overflow they follow the policy; the default one throws the error of
+        // checked_add, checked_sub, checked_mul and checked_div. Division by zero always throws runtime_error,
+        // except under OverflowPolicy::Unchecked where it gives a zero denominator.
+        constexpr arithmetic_type operator+(const BasicFraction& other) const; // Addition operator
+        constexpr arithmetic_type operator-(const BasicFraction& other) const; // Subtraction operator
+        constexpr arithmetic_type operator*(const BasicFraction& other) const; // Multiplication operator
+        constexpr arithmetic_type operator/(const BasicFraction& other) const; // Division operator
 
         // Operator overloads to perform arithmetic with float on the left hand side
-        friend Fraction operator+(float lhs, const Fraction& rhs);
-        friend Fraction operator-(float lhs, const Fraction& rhs);
-        friend Fraction operator*(float lhs, const Fraction& rhs);
-        friend Fraction operator/(float lhs, const Fraction& rhs);
+        friend arithmetic_type operator+(float lhs, const BasicFraction& rhs) {
+            // The addition is commutative, so we can use the + operator for two Fractions.
+            return rhs + BasicFraction(lhs);
+        }
+
+        friend arithmetic_type operator-(float lhs, const BasicFraction& rhs) {
+            // Convert the float to a Fraction and perform the subtraction using the - operator for two Fractions.
+            return BasicFraction(lhs) - rhs;
+        }
+
+        friend arithmetic_type operator*(float lhs, const BasicFraction& rhs) {
+            // The multiplication is commutative, so we can use the * operator for two Fractions.
+            return rhs * lhs;
+        }
+
+        friend arithmetic_type operator/(float lhs, const BasicFraction& rhs) {
+            // Check if the divisor is zero, if so, throw an exception.
+            if (rhs.numerator == 0) {
+                throw std::runtime_error("Division by zero is not allowed.");
+            }
+            // Convert the float to a Fraction and then perform the division using the / operator for two Fractions.
+            return BasicFraction(lhs) / rhs;
+        }
 
         // Comparison operators
-        bool operator<(const Fraction& other) const;  // Less than operator
-        bool operator<=(const Fraction& other) const; // Less than or equal to operator
-        bool operator>(const Fraction& other) const;  // Greater than operator
-        bool operator>=(const Fraction& other) const; // Greater than or equal to operator
-        bool operator==(const Fraction& other) const; // Equality operator
+        // <, <=, > and >= are all rewritten by the compiler in terms of operator<=>
+        constexpr std::strong_ordering operator<=>(const BasicFraction& other) const; // Three-way comparison operator
+        constexpr bool operator==(const BasicFraction& other) const; // Equality operator
+
+        // Tolerance used when a fraction is compared with a float (3 digits beyond the decimal point)
+        static constexpr float FLOAT_TOLERANCE = 0.001F;
+
+        // Returns true if the fraction differs from the given float by less than the tolerance
+        bool approx_equal(float value, float tolerance = FLOAT_TOLERANCE) const;
 
         // Operator overloads to perform comparison with float on the left hand side
-        friend bool operator==(float lhs, const Fraction& rhs);
-        friend bool operator<(float lhs, const Fraction& rhs);
-        friend bool operator>(float lhs, const Fraction& rhs);
-        friend bool operator<=(float lhs, const Fraction& rhs);
-        friend bool operator>=(float lhs, const Fraction& rhs);
+        friend bool operator==(float lhs, const BasicFraction& rhs) {
+            // A float only carries 3 decimal digits of precision for fractions,
+            // so they are equal if they agree up to that precision.
+            return rhs.approx_equal(lhs);
+        }
+
+        friend bool operator<(float lhs, const BasicFraction& rhs) {
+            return BasicFraction(lhs) < rhs;
+        }
+
+        friend bool operator>(float lhs, const BasicFraction& rhs) {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(float lhs, const BasicFraction& rhs) {
+            return !(lhs > rhs);
+        }
+
+        friend bool operator>=(float lhs, const BasicFraction& rhs) {
+            return !(lhs < rhs);
+        }
 
         // Increment and decrement operators
-        Fraction& operator++();    // Prefix increment operator
-        Fraction operator++(int);  // Postfix increment operator
-        Fraction& operator--();    // Prefix decrement operator
-        Fraction operator--(int);  // Postfix decrement operator
-
-        // Stream operators
-        friend std::ostream& operator<<(std::ostream& stream, const Fraction& frac); // Output stream operator
-        friend std::istream& operator>>(std::istream& stream, Fraction& frac); // Input stream operator
+        constexpr BasicFraction& operator++();    // Prefix increment operator
+        constexpr BasicFraction operator++(int);  // Postfix increment operator
+        constexpr BasicFraction& operator--();    // Prefix decrement operator
+        constexpr BasicFraction operator--(int);  // Postfix decrement operator
+
+        // Longest text written by to_chars: two signed values and the slash
+        static constexpr std::size_t MAX_CHARS = 2 * (detail::maxDecimalDigits(sizeof(IntT) * 8) + 1) + 1;
+
+        // Stream operators, both built on to_chars and from_chars
+        // Output stream operator, writes the fraction in the format numerator/denominator
+        friend std::ostream& operator<<(std::ostream& stream, const BasicFraction& frac) {
+            char text[MAX_CHARS];
+            std::to_chars_result result = to_chars(text, text + MAX_CHARS, frac);
+            return stream.write(text, result.ptr - text);
+        }
+
+        // Input stream operator, reads the fraction in the format numerator/denominator or numerator denominator
+        // Throws runtime_error on malformed input or a zero denominator
+        friend std::istream& operator>>(std::istream& stream, BasicFraction& frac) {
+            // Both tokens are read into one buffer, leaving room for some leading zeros
+            char text[2 * MAX_CHARS];
+            char* end = detail::readToken(stream, text, text + MAX_CHARS);
+            if (end != nullptr && std::find(text, end, '/') == end) {
+                *end++ = ' ';
+                end = detail::readToken(stream, end, text + sizeof(text));
+            }
+            if (end == nullptr) {
+                throw std::runtime_error("Invalid input");
+            }
+            BasicFraction result;
+            std::from_chars_result parsed = from_chars(text, end, result);
+            if (parsed.ec == std::errc::argument_out_of_domain) {
+                throw std::runtime_error("Division by Zero");
+            }
+            if (parsed.ec != std::errc{} || parsed.ptr != end) {
+                stream.setstate(std::ios::failbit);
+                throw std::runtime_error("Invalid input");
+            }
+            frac = result;
+            return stream;
+        }
     };
+
+    using Fraction = BasicFraction<int>;          // The default fraction, two ints
+    using Fraction8 = BasicFraction<std::int8_t>;   // Dense storage for tiny values
+    using Fraction16 = BasicFraction<std::int16_t>; // Dense storage for small values
+    using Fraction64 = BasicFraction<std::int64_t>; // Wide values
+    using Fraction128 = BasicFraction<int128_t>;    // Accumulators
+
+    // Fraction default constructor: Initializes fraction as 0/1
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr BasicFraction<IntT, Policy>::BasicFraction() : numerator(0), denominator(1) {}
+
+    // Fraction constructor: Initializes fraction with given numerator and denominator
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr BasicFraction<IntT, Policy>::BasicFraction(IntT numerator, IntT denominator)
+            : BasicFraction(try_make(numerator, denominator).value()) {
+        detail::countStat(StatCounter::Constructions);
+        detail::countTerms(*this);
+    }
+
+    // Reduces the fraction with a single gcd and moves the sign to the numerator. The minimum value
+    // has no positive counterpart, so a negative denominator can't always be flipped.
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::try_make(IntT numerator, IntT denominator)
+            -> CheckedResult<BasicFraction> {
+        if (denominator == 0) {
+            return FractionError::ZeroDenominator;
+        }
+        auto gcd = static_cast<IntT>(Traits::gcd(numerator, denominator));
+        numerator /= gcd;
+        denominator /= gcd;
+        if (denominator < 0) {
+            if (numerator == Traits::min() || denominator == Traits::min()) {
+                return FractionError::Overflow;
+            }
+            numerator = -numerator;
+            denominator = -denominator;
+        }
+        BasicFraction result;
+        result.numerator = numerator;
+        result.denominator = denominator;
+        return result;
+    }
+
+    // Fraction constructor: Initializes fraction with given floating point number
+    // Throws overflow_error if the value does not fit in IntT
+    template<typename IntT, OverflowPolicy Policy>
+    BasicFraction<IntT, Policy>::BasicFraction(float f) {
+        // Convert float to fraction by shifting decimal point to the right
+        // until we get an integer numerator
+        double scale = 1;
+        for (int i = 0; i < 3 && f != std::round(f); i++) {
+            f *= 10;
+            scale *= 10;
+        }
+        double scaled = std::round(f);
+        if (scaled < static_cast<double>(Traits::min()) || scaled > static_cast<double>(Traits::max()) ||
+            scale > static_cast<double>(Traits::max())) {
+            throwFractionError(FractionError::Overflow);
+        }
+        this->numerator = static_cast<IntT>(scaled);
+        this->denominator = static_cast<IntT>(scale);
+        simplify(); // Simplify the fraction if possible
+        detail::countStat(StatCounter::Constructions);
+        detail::countTerms(*this);
+    }
+
+    // The magnitude of a negative numerator may be one more than the maximum
+    template<typename IntT, OverflowPolicy Policy>
+    bool BasicFraction<IntT, Policy>::tryFromRatio(bool negative, detail::UnsignedRatio ratio, BasicFraction &result) {
+        auto limit = static_cast<uint128_t>(Traits::max());
+        if (ratio.denominator == 0 || ratio.numerator > limit + (negative ? 1 : 0) || ratio.denominator > limit) {
+            return false;
+        }
+        // Conversion to a signed type wraps, which gives the minimum value for its magnitude too
+        result.numerator = static_cast<IntT>(negative ? uint128_t{0} - ratio.numerator : ratio.numerator);
+        result.denominator = static_cast<IntT>(ratio.denominator);
+        return true;
+    }
+
+    template<typename IntT, OverflowPolicy Policy>
+    BasicFraction<IntT, Policy> BasicFraction<IntT, Policy>::fromRatio(bool negative, detail::UnsignedRatio ratio) {
+        BasicFraction result;
+        if (!tryFromRatio(negative, ratio, result)) {
+            throwFractionError(FractionError::Overflow);
+        }
+        return result;
+    }
+
+    // Expands the exact value of the double as a continued fraction and stops at the last convergent
+    // (or semiconvergent) within the bounds. No floating point arithmetic is involved.
+    template<typename IntT, OverflowPolicy Policy>
+    BasicFraction<IntT, Policy> BasicFraction<IntT, Policy>::from_double(double value, IntT max_denominator) {
+        if (max_denominator < 1) {
+            throw std::invalid_argument("Denominator bound must be positive");
+        }
+        detail::DecodedDouble decoded = detail::decodeDouble(value);
+        detail::UnsignedRatio best = detail::bestApproximation(detail::toRatio(decoded),
+                                                               static_cast<uint128_t>(Traits::max()),
+                                                               static_cast<uint128_t>(max_denominator));
+        return fromRatio(decoded.negative, best);
+    }
+
+    // A float stands for every real number that rounds to it. The ends of that interval are halfway to the
+    // neighbouring floats, which a double holds exactly, and the simplest fraction strictly inside it is
+    // found by expanding both ends as continued fractions.
+    template<typename IntT, OverflowPolicy Policy>
+    BasicFraction<IntT, Policy> BasicFraction<IntT, Policy>::from_float(float value, IntT max_denominator) {
+        detail::DecodedDouble decoded = detail::decodeDouble(value);
+        if (decoded.exponent >= 0) {
+            // Integers are returned as they are rather than as the smallest integer rounding to them
+            return from_double(value, max_denominator);
+        }
+        const std::uint32_t magnitude_mask = 0x7fffffff;
+        std::uint32_t bits = std::bit_cast<std::uint32_t>(value) & magnitude_mask;
+        double magnitude = std::bit_cast<float>(bits);
+        double lower = (static_cast<double>(std::bit_cast<float>(bits - 1)) + magnitude) / 2;
+        double upper = (static_cast<double>(std::bit_cast<float>(bits + 1)) + magnitude) / 2;
+        detail::UnsignedRatio lower_ratio{0, 1};
+        detail::UnsignedRatio upper_ratio{0, 1};
+        if (detail::exactRatio(detail::decodeDouble(lower), lower_ratio) &&
+            detail::exactRatio(detail::decodeDouble(upper), upper_ratio)) {
+            detail::UnsignedRatio simplest = detail::simplestBetween(lower_ratio, upper_ratio);
+            if (simplest.numerator <= static_cast<uint128_t>(Traits::max()) &&
+                simplest.denominator <= static_cast<uint128_t>(max_denominator)) {
+                return fromRatio(decoded.negative, simplest);
+            }
+        }
+        return from_double(value, max_denominator);
+    }
+
+    // Reads the mantissa and exponent straight from the IEEE 754 fields: value = mantissa * 2^exponent
+    template<typename IntT, OverflowPolicy Policy>
+    BasicFraction<IntT, Policy> BasicFraction<IntT, Policy>::from_double_exact(double value) {
+        detail::DecodedDouble decoded = detail::decodeDouble(value);
+        const int digits = static_cast<int>(sizeof(IntT) * 8) - 1;
+        detail::UnsignedRatio exact{0, 1};
+        // Only a power of two below 2^digits fits as a denominator
+        if (-decoded.exponent >= digits || !detail::exactRatio(decoded, exact)) {
+            throwFractionError(FractionError::Overflow);
+        }
+        return fromRatio(decoded.negative, exact);
+    }
+
+    // Getter for numerator
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr IntT BasicFraction<IntT, Policy>::getNumerator() const {
+        return this->numerator;
+    }
+
+    // Getter for denominator
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr IntT BasicFraction<IntT, Policy>::getDenominator() const {
+        return this->denominator;
+    }
+
+    // Builds a fraction from a wide numerator/denominator pair produced by the arithmetic operators.
+    // The pair is reduced with a single gcd; only if the reduced value does not fit in IntT
+    // does it fail with Overflow. The denominator is expected to be positive.
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::fromWide(WideT numerator, WideT denominator)
+            -> CheckedResult<BasicFraction> {
+        WideT gcd = Traits::gcd(numerator, denominator);
+        numerator /= gcd;
+        denominator /= gcd;
+        if (!Traits::fits(numerator) || !Traits::fits(denominator)) {
+            return FractionError::Overflow;
+        }
+        BasicFraction result;
+        result.numerator = static_cast<IntT>(numerator);
+        result.denominator = static_cast<IntT>(denominator);
+        return result;
+    }
+
+    // Adds two fractions using only IntT arithmetic (Knuth, TAOCP 4.5.1).
+    // With g = gcd(b, d): a/b + c/d = (a*(d/g) + c*(b/g)) / (b/g * d), and the only common factor
+    // left between that numerator and denominator divides g. Every step is overflow checked.
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::addChecked(const BasicFraction &lhs, const BasicFraction &rhs,
+                                                           bool subtract) -> CheckedResult<BasicFraction> {
+        IntT gcd = static_cast<IntT>(Traits::gcd(lhs.denominator, rhs.denominator));
+        IntT lhs_scale = rhs.denominator / gcd;
+        IntT rhs_scale = lhs.denominator / gcd;
+        IntT term1 = 0;
+        IntT term2 = 0;
+        IntT sum = 0;
+        if (__builtin_mul_overflow(lhs.numerator, lhs_scale, &term1) ||
+            __builtin_mul_overflow(rhs.numerator, rhs_scale, &term2) ||
+            (subtract ? __builtin_sub_overflow(term1, term2, &sum) : __builtin_add_overflow(term1, term2, &sum))) {
+            return FractionError::Overflow;
+        }
+        if (sum == 0) {
+            return BasicFraction();
+        }
+        IntT common = static_cast<IntT>(Traits::gcd(sum, gcd));
+        IntT new_denominator = 0;
+        if (__builtin_mul_overflow(rhs_scale, rhs.denominator / common, &new_denominator)) {
+            return FractionError::Overflow;
+        }
+        BasicFraction result;
+        result.numerator = sum / common;
+        result.denominator = new_denominator;
+        return result;
+    }
+
+    // The cross products are formed in the wide type where they can't overflow
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::addReduced(const BasicFraction &lhs, const BasicFraction &rhs,
+                                                           bool subtract) -> CheckedResult<BasicFraction> {
+        if constexpr (!Traits::has_wide_type) {
+            return addChecked(lhs, rhs, subtract);
+        } else {
+            WideT rhs_numerator = subtract ? -static_cast<WideT>(rhs.numerator) : static_cast<WideT>(rhs.numerator);
+            if (lhs.denominator == rhs.denominator) {
+                return fromWide(static_cast<WideT>(lhs.numerator) + rhs_numerator, lhs.denominator);
+            }
+            WideT new_numerator = static_cast<WideT>(lhs.numerator) * rhs.denominator + rhs_numerator * lhs.denominator;
+            return fromWide(new_numerator, static_cast<WideT>(lhs.denominator) * rhs.denominator);
+        }
+    }
+
+    // Adds two fractions, fails with Overflow only if the reduced sum does not fit in IntT
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr CheckedResult<BasicFraction<IntT, Policy>> checked_add(const BasicFraction<IntT, Policy> &lhs,
+                                                             const BasicFraction<IntT, Policy> &rhs) {
+        return BasicFraction<IntT, Policy>::addReduced(lhs, rhs, false);
+    }
+
+    // Subtracts two fractions, same scheme as addition
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr CheckedResult<BasicFraction<IntT, Policy>> checked_sub(const BasicFraction<IntT, Policy> &lhs,
+                                                             const BasicFraction<IntT, Policy> &rhs) {
+        return BasicFraction<IntT, Policy>::addReduced(lhs, rhs, true);
+    }
+
+    // Multiplies two reduced fractions a/b and c/d with cross-cancellation: gcd(a, d) and gcd(c, b) are
+    // divided out before multiplying, so the products are already the reduced result and Overflow
+    // is only returned if that result does not fit in IntT. d may be negative, b must be positive.
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr CheckedResult<BasicFraction<IntT, Policy>> BasicFraction<IntT, Policy>::multiplyReduced(
+            IntT lhs_numerator, IntT lhs_denominator, IntT rhs_numerator, IntT rhs_denominator) {
+        auto lhs_gcd = static_cast<IntT>(Traits::gcd(lhs_numerator, rhs_denominator));
+        auto rhs_gcd = static_cast<IntT>(Traits::gcd(rhs_numerator, lhs_denominator));
+        IntT new_numerator = 0;
+        IntT new_denominator = 0;
+        if (__builtin_mul_overflow(lhs_numerator / lhs_gcd, rhs_numerator / rhs_gcd, &new_numerator) ||
+            __builtin_mul_overflow(lhs_denominator / rhs_gcd, rhs_denominator / lhs_gcd, &new_denominator)) {
+            return FractionError::Overflow;
+        }
+        // Keep the denominator positive, the minimum value has no positive counterpart
+        if (new_denominator < 0) {
+            if (new_numerator == Traits::min() || new_denominator == Traits::min()) {
+                return FractionError::Overflow;
+            }
+            new_numerator = -new_numerator;
+            new_denominator = -new_denominator;
+        }
+        BasicFraction result;
+        result.numerator = new_numerator;
+        result.denominator = new_denominator;
+        return result;
+    }
+
+    // Multiplies two fractions, fails with Overflow only if the reduced product does not fit in IntT
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr CheckedResult<BasicFraction<IntT, Policy>> checked_mul(const BasicFraction<IntT, Policy> &lhs,
+                                                             const BasicFraction<IntT, Policy> &rhs) {
+        if (lhs.numerator == 0 || rhs.numerator == 0) {
+            return BasicFraction<IntT, Policy>();  // If either fraction is 0, return 0
+        }
+        return BasicFraction<IntT, Policy>::multiplyReduced(lhs.numerator, lhs.denominator,
+                                                            rhs.numerator, rhs.denominator);
+    }
+
+    // Divides one fraction by another by multiplying with its reciprocal
+    // Fails with DivisionByZero if rhs is zero and with Overflow if the reduced quotient does not fit in IntT
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr CheckedResult<BasicFraction<IntT, Policy>> checked_div(const BasicFraction<IntT, Policy> &lhs,
+                                                             const BasicFraction<IntT, Policy> &rhs) {
+        if (rhs.numerator == 0) {
+            return FractionError::DivisionByZero;
+        }
+        if (lhs.numerator == 0) {
+            return BasicFraction<IntT, Policy>();
+        }
+        return BasicFraction<IntT, Policy>::multiplyReduced(lhs.numerator, lhs.denominator,
+                                                            rhs.denominator, rhs.numerator);
+    }
+
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::checkedOperation(const BasicFraction &lhs, const BasicFraction &rhs,
+                                                                 Operation operation) -> CheckedResult<BasicFraction> {
+        switch (operation) {
+            case Operation::Add:
+                return checked_add(lhs, rhs);
+            case Operation::Subtract:
+                return checked_sub(lhs, rhs);
+            case Operation::Multiply:
+                return checked_mul(lhs, rhs);
+            case Operation::Divide:
+                break;
+        }
+        return checked_div(lhs, rhs);
+    }
+
+    // Unsigned arithmetic wraps instead of overflowing, and converting back to a signed type wraps too.
+    // The sign of the denominator is moved to the numerator with masks rather than a branch.
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::wideResult(const BasicFraction &lhs, const BasicFraction &rhs,
+                                                           Operation operation)
+            -> std::pair<UnsignedWideT, UnsignedWideT> {
+        auto wide = [](IntT value) { return static_cast<UnsignedWideT>(static_cast<WideT>(value)); };
+        UnsignedWideT numerator = 0;
+        UnsignedWideT denominator = 0;
+        switch (operation) {
+            case Operation::Add:
+                numerator = wide(lhs.numerator) * wide(rhs.denominator) + wide(rhs.numerator) * wide(lhs.denominator);
+                denominator = wide(lhs.denominator) * wide(rhs.denominator);
+                break;
+            case Operation::Subtract:
+                numerator = wide(lhs.numerator) * wide(rhs.denominator) - wide(rhs.numerator) * wide(lhs.denominator);
+                denominator = wide(lhs.denominator) * wide(rhs.denominator);
+                break;
+            case Operation::Multiply:
+                numerator = wide(lhs.numerator) * wide(rhs.numerator);
+                denominator = wide(lhs.denominator) * wide(rhs.denominator);
+                break;
+            case Operation::Divide:
+                numerator = wide(lhs.numerator) * wide(rhs.denominator);
+                denominator = wide(lhs.denominator) * wide(rhs.numerator);
+                break;
+        }
+        const unsigned sign_shift = sizeof(UnsignedWideT) * 8 - 1;
+        UnsignedWideT sign = UnsignedWideT{0} - (denominator >> sign_shift);
+        return {(numerator ^ sign) - sign, (denominator ^ sign) - sign};
+    }
+
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::withPolicy(const BasicFraction &lhs, const BasicFraction &rhs,
+                                                           Operation operation) {
+        if constexpr (Policy == OverflowPolicy::Throw || (Policy == OverflowPolicy::Promote && !Traits::has_wide_type)) {
+            return checkedOperation(lhs, rhs, operation).value();
+        } else if constexpr (Policy == OverflowPolicy::Unchecked) {
+            // One gcd and no overflow checks; a zero gcd only comes from 0/0 and is replaced by 1
+            auto [wide_numerator, wide_denominator] = wideResult(lhs, rhs, operation);
+            auto numerator = static_cast<WideT>(wide_numerator);
+            auto denominator = static_cast<WideT>(wide_denominator);
+            WideT gcd = Traits::gcd(numerator, denominator);
+            gcd += static_cast<WideT>(gcd == 0);
+            BasicFraction result;
+            result.numerator = static_cast<IntT>(numerator / gcd);
+            result.denominator = static_cast<IntT>(denominator / gcd);
+            return result;
+        } else {
+            if (operation == Operation::Divide && rhs.numerator == 0) {
+                throw std::runtime_error("Division by zero");
+            }
+            if constexpr (Policy == OverflowPolicy::Promote) {
+                // The wide products are exact and the denominator is positive, so this can't fail
+                auto [numerator, denominator] = wideResult(lhs, rhs, operation);
+                return *BasicFraction<WideT, Policy>::try_make(static_cast<WideT>(numerator),
+                                                               static_cast<WideT>(denominator));
+            } else {
+                CheckedResult<BasicFraction> result = checkedOperation(lhs, rhs, operation);
+                if (result) {
+                    return *result;
+                }
+                // Saturate to the best approximation of the exact result whose terms fit in IntT. A value
+                // whose integer part is out of range has none and becomes the minimum or maximum instead.
+                auto [wide_numerator, wide_denominator] = wideResult(lhs, rhs, operation);
+                auto numerator = static_cast<WideT>(wide_numerator);
+                bool negative = numerator < 0;
+                auto limit = static_cast<uint128_t>(Traits::max());
+                detail::UnsignedRatio best = detail::bestApproximation(
+                        {detail::magnitude128(numerator), static_cast<uint128_t>(wide_denominator)},
+                        limit + (negative ? 1 : 0), limit);
+                if (best.denominator == 0) {
+                    best = {limit + (negative ? 1 : 0), 1};
+                }
+                BasicFraction saturated;
+                tryFromRatio(negative, best, saturated);
+                return saturated;
+            }
+        }
+    }
+
+    // Addition operator: Adds two fractions
+    // Overflows only if the reduced sum does not fit in IntT
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::operator+(const BasicFraction &other) const -> arithmetic_type {
+        detail::countStat(StatCounter::Additions);
+        return detail::countTerms(withPolicy(*this, other, Operation::Add));
+    }
+
+    // Subtraction operator: Subtracts two fractions
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::operator-(const BasicFraction &other) const -> arithmetic_type {
+        detail::countStat(StatCounter::Subtractions);
+        return detail::countTerms(withPolicy(*this, other, Operation::Subtract));
+    }
+
+    // Multiplication operator: Multiplies two fractions
+    // Overflows only if the reduced product does not fit in IntT
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::operator*(const BasicFraction &other) const -> arithmetic_type {
+        detail::countStat(StatCounter::Multiplications);
+        return detail::countTerms(withPolicy(*this, other, Operation::Multiply));
+    }
+
+    // Division operator: Divides one fraction by another
+    // Throws runtime_error if dividing by zero
+    // Overflows only if the reduced quotient does not fit in IntT
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr auto BasicFraction<IntT, Policy>::operator/(const BasicFraction &other) const -> arithmetic_type {
+        detail::countStat(StatCounter::Divisions);
+        return detail::countTerms(withPolicy(*this, other, Operation::Divide));
+    }
+
+    // Compares two fractions by their continued fraction expansions, so no product can overflow.
+    // The integer parts are compared first; if they are equal the fractional parts r1/b and r2/d
+    // compare like the reciprocals d/r2 and b/r1, which are expanded the same way.
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr std::strong_ordering BasicFraction<IntT, Policy>::compareChecked(const BasicFraction &lhs,
+                                                                               const BasicFraction &rhs) {
+        IntT lhs_product = 0;
+        IntT rhs_product = 0;
+        if (!__builtin_mul_overflow(lhs.numerator, rhs.denominator, &lhs_product) &&
+            !__builtin_mul_overflow(rhs.numerator, lhs.denominator, &rhs_product)) {
+            return lhs_product <=> rhs_product;
+        }
+        IntT a = lhs.numerator;
+        IntT b = lhs.denominator;
+        IntT c = rhs.numerator;
+        IntT d = rhs.denominator;
+        while (true) {
+            // Floor division, the remainders end up in [0, denominator). They are corrected directly rather
+            // than computed as a - whole * b, which overflows for numerators near the minimum.
+            IntT lhs_whole = a / b;
+            IntT rhs_whole = c / d;
+            IntT lhs_rest = a % b;
+            IntT rhs_rest = c % d;
+            if (lhs_rest < 0) {
+                lhs_whole--;
+                lhs_rest += b;
+            }
+            if (rhs_rest < 0) {
+                rhs_whole--;
+                rhs_rest += d;
+            }
+            if (lhs_whole != rhs_whole) {
+                return lhs_whole <=> rhs_whole;
+            }
+            if (lhs_rest == 0 || rhs_rest == 0) {
+                return lhs_rest <=> rhs_rest;
+            }
+            a = d;
+            c = b;
+            b = rhs_rest;
+            d = lhs_rest;
+        }
+    }
+
+    // Three-way comparison operator: Compares two fractions exactly
+    // Denominators are always positive, so a/b <=> c/d has the same sign as a*d <=> c*b.
+    // Both products are formed in the wide type and can't overflow. The compiler rewrites
+    // <, <=, > and >= in terms of this operator.
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr std::strong_ordering BasicFraction<IntT, Policy>::operator<=>(const BasicFraction &other) const {
+        detail::countStat(StatCounter::Comparisons);
+        if constexpr (!Traits::has_wide_type) {
+            return compareChecked(*this, other);
+        } else {
+            return static_cast<WideT>(numerator) * other.denominator <=>
+                   static_cast<WideT>(other.numerator) * denominator;
+        }
+    }
+
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr bool BasicFraction<IntT, Policy>::operator==(const BasicFraction &other) const {
+        // Compares two fractions. Every fraction is kept reduced with a positive denominator,
+        // so two fractions are equal exactly when their numerators and denominators are equal.
+        detail::countStat(StatCounter::Comparisons);
+        return numerator == other.numerator && denominator == other.denominator;
+    }
+
+    template<typename IntT, OverflowPolicy Policy>
+    bool BasicFraction<IntT, Policy>::approx_equal(float value, float tolerance) const {
+        // Compares the fraction with a float. Returns true if they differ by less than the tolerance.
+        return std::abs(static_cast<double>(numerator) / static_cast<double>(denominator) - value) < tolerance;
+    }
+
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr BasicFraction<IntT, Policy> &BasicFraction<IntT, Policy>::operator++() {
+        // Prefix increment operator. Adds the denominator to the numerator and returns the updated fraction.
+        detail::countStat(StatCounter::Increments);
+        this->numerator += this->denominator;
+        return *this;
+    }
+
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr BasicFraction<IntT, Policy> BasicFraction<IntT, Policy>::operator++(int) {
+        // Postfix increment operator. Creates a copy of the fraction, then adds the denominator to the
+        // numerator of the original fraction.
+        // Returns the copy.
+        detail::countStat(StatCounter::Increments);
+        BasicFraction temp = *this;
+        this->numerator += this->denominator;
+        return temp;
+    }
+
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr BasicFraction<IntT, Policy> &BasicFraction<IntT, Policy>::operator--() {
+        // Prefix decrement operator. Subtracts the denominator from the numerator and returns the updated fraction.
+        detail::countStat(StatCounter::Decrements);
+        this->numerator -= this->denominator;
+        return *this;
+    }
+
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr BasicFraction<IntT, Policy> BasicFraction<IntT, Policy>::operator--(int) {
+        // Postfix decrement operator. Creates a copy of the fraction, then subtracts the denominator from the numerator of the original fraction.
+        // Returns the copy.
+        detail::countStat(StatCounter::Decrements);
+        BasicFraction temp = *this;
+        this->numerator -= this->denominator;
+        return temp;
+    }
+
+    template<typename IntT, OverflowPolicy Policy>
+    constexpr void BasicFraction<IntT, Policy>::simplify() {
+        // The purpose of this function is to simplify the fraction to its simplest form.
+        // The gcd of the numerator and denominator is the largest positive integer that divides both numbers
+        // without leaving a remainder. The traits pick the gcd implementation suited to the width.
+        detail::countStat(StatCounter::Simplifications);
+        auto g = static_cast<IntT>(Traits::gcd(numerator, denominator));
+        // The numerator and denominator are both divided by their GCD.
+        // This effectively reduces the fraction to its simplest form.
+        numerator /= g;
+        denominator /= g;
+        // If the denominator is less than 0 (negative), the signs of both the numerator and denominator are flipped.
+        // This is a convention in mathematics to always have the denominator as positive.
+        if (denominator < 0) {
+            numerator = -numerator;
+            denominator = -denominator;
+        }
+    }
+
+    // Writes the fraction as numerator/denominator like std::to_chars: no locale, no allocation and no
+    // exceptions. Returns value_too_large and last if the range is too small, MAX_CHARS is always enough.
+    template<typename IntT, OverflowPolicy Policy>
+    std::to_chars_result to_chars(char *first, char *last, const BasicFraction<IntT, Policy> &value) {
+        std::to_chars_result result = detail::formatInteger(first, last, value.getNumerator());
+        if (result.ec != std::errc{} || result.ptr == last) {
+            return {last, std::errc::value_too_large};
+        }
+        *result.ptr++ = '/';
+        return detail::formatInteger(result.ptr, last, value.getDenominator());
+    }
+
+    // Parses a fraction written as numerator/denominator or as numerator and denominator separated by
+    // spaces or tabs, each an optionally negative decimal integer. Like std::from_chars it never throws;
+    // on error value is left unchanged and ec is
+    // - invalid_argument if the text does not start with a fraction (ptr is first)
+    // - result_out_of_range if the reduced fraction does not fit in IntT
+    // - argument_out_of_domain if the denominator is zero
+    // The fraction is reduced with a single gcd.
+    template<typename IntT, OverflowPolicy Policy>
+    std::from_chars_result from_chars(const char *first, const char *last, BasicFraction<IntT, Policy> &value) {
+        using UIntT = std::conditional_t<sizeof(IntT) <= sizeof(std::uint64_t), std::uint64_t, uint128_t>;
+        bool numerator_negative = false;
+        bool denominator_negative = false;
+        UIntT numerator = 0;
+        UIntT denominator = 0;
+        std::from_chars_result result = detail::parseSigned(first, last, numerator_negative, numerator);
+        if (result.ec != std::errc{}) {
+            return result;
+        }
+        const char *next = result.ptr;
+        if (next != last && *next == '/') {
+            ++next;
+        } else {
+            const char *separator = next;
+            while (next != last && (*next == ' ' || *next == '\t')) {
+                ++next;
+            }
+            if (next == separator) {
+                return {first, std::errc::invalid_argument};
+            }
+        }
+        result = detail::parseSigned(next, last, denominator_negative, denominator);
+        if (result.ec == std::errc::invalid_argument) {
+            return {first, std::errc::invalid_argument};
+        }
+        if (result.ec != std::errc{}) {
+            return result;
+        }
+        if (denominator == 0) {
+            return {result.ptr, std::errc::argument_out_of_domain};
+        }
+        UIntT gcd = 0;
+        if constexpr (sizeof(UIntT) <= sizeof(std::uint64_t)) {
+            gcd = binaryGcd(numerator, denominator);
+        } else {
+            gcd = lehmerGcd(numerator, denominator);
+        }
+        detail::UnsignedRatio ratio{numerator / gcd, denominator / gcd};
+        if (!BasicFraction<IntT, Policy>::tryFromRatio(numerator_negative != denominator_negative && numerator != 0,
+                                                       ratio, value)) {
+            return {result.ptr, std::errc::result_out_of_range};
+        }
+        return result;
+    }
+
+#ifndef FRACTION_HEADER_ONLY
+    // The int fraction is compiled once in Fraction.cpp instead of in every translation unit.
+    // Defining FRACTION_HEADER_ONLY (make HEADER_ONLY=1) compiles it in every translation unit instead,
+    // so the conversions and stream operators can be inlined too; the constexpr members always can be.
+    extern template class BasicFraction<int>;
+#endif
 }
 
-#endif //FRACTION_B_FRACTION_HPP
+// Hashes the reduced terms, consistent with operator==
+template<typename IntT, ariel::OverflowPolicy Policy>
+struct std::hash<ariel::BasicFraction<IntT, Policy>> {
+    std::size_t operator()(const ariel::BasicFraction<IntT, Policy>& value) const noexcept {
+        return ariel::detail::hashTerms(value.getNumerator(), value.getDenominator());
+    }
+};
 
+#endif //FRACTION_B_FRACTION_HPP
@@ -0,0 +1,359 @@
+//
+// Compact variable-length encoding of int fraction sequences.
+//
+#include "FractionCodec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <immintrin.h>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+// Functions compiled for an instruction set the rest of the build does not assume
+#define FRACTION_SSE4 __attribute__((target("sse4.2")))
+
+namespace ariel {
+
+    namespace {
+        const unsigned VARINT_BITS = 7;
+        const std::uint8_t VARINT_MORE = 0x80;
+        const unsigned BITS_PER_LENGTH = 2;
+        const std::uint8_t LENGTH_MASK = 3;
+        const std::size_t VALUES_PER_CONTROL = 4;
+
+        // The Stream VByte loop loads this many data bytes per control byte, whatever the lengths
+        const std::size_t VECTOR_BYTES = 16;
+
+        [[noreturn]] void invalidEncoding() {
+            throw std::runtime_error("Invalid fraction encoding");
+        }
+
+        void writeVarint(std::vector<std::uint8_t> &out, std::uint64_t value) {
+            while (value >= VARINT_MORE) {
+                out.push_back(static_cast<std::uint8_t>(value | VARINT_MORE));
+                value >>= VARINT_BITS;
+            }
+            out.push_back(static_cast<std::uint8_t>(value));
+        }
+
+        // Maps 0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+        std::uint32_t zigzag(int value) {
+            const unsigned sign_shift = 31;
+            return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> sign_shift);
+        }
+
+        // Bytes needed by a value, 1 to 4
+        unsigned byteLength(std::uint32_t value) {
+            return value == 0 ? 1 : static_cast<unsigned>(std::bit_width(value) + 7) / 8;
+        }
+
+        // Appends the values as one Stream VByte sequence: the size of the data, the control bytes and the data
+        void writeStream(std::vector<std::uint8_t> &out, const std::vector<std::uint32_t> &values) {
+            std::vector<std::uint8_t> controls((values.size() + VALUES_PER_CONTROL - 1) / VALUES_PER_CONTROL, 0);
+            std::vector<std::uint8_t> data;
+            data.reserve(values.size());
+            for (std::size_t i = 0; i < values.size(); i++) {
+                unsigned length = byteLength(values[i]);
+                controls[i / VALUES_PER_CONTROL] |=
+                        static_cast<std::uint8_t>((length - 1) << (BITS_PER_LENGTH * (i % VALUES_PER_CONTROL)));
+                for (unsigned byte = 0; byte < length; byte++) {
+                    data.push_back(static_cast<std::uint8_t>(values[i] >> (8 * byte)));
+                }
+            }
+            writeVarint(out, data.size());
+            out.insert(out.end(), controls.begin(), controls.end());
+            out.insert(out.end(), data.begin(), data.end());
+        }
+
+        // Reads the encoding front to back, throwing on anything out of bounds
+        class Input {
+        private:
+            std::span<const std::uint8_t> bytes;
+            std::size_t position = 0;
+
+        public:
+            explicit Input(std::span<const std::uint8_t> bytes) : bytes(bytes) {}
+
+            bool atEnd() const { return position == bytes.size(); }
+
+            std::uint8_t readByte() {
+                if (atEnd()) {
+                    invalidEncoding();
+                }
+                return bytes[position++];
+            }
+
+            std::uint64_t readVarint() {
+                std::uint64_t value = 0;
+                for (unsigned shift = 0; shift < std::numeric_limits<std::uint64_t>::digits; shift += VARINT_BITS) {
+                    std::uint8_t byte = readByte();
+                    value |= static_cast<std::uint64_t>(byte & ~VARINT_MORE) << shift;
+                    if ((byte & VARINT_MORE) == 0) {
+                        return value;
+                    }
+                }
+                invalidEncoding();
+            }
+
+            // The next size bytes
+            std::span<const std::uint8_t> take(std::uint64_t size) {
+                if (size > bytes.size() - position) {
+                    invalidEncoding();
+                }
+                std::span<const std::uint8_t> result = bytes.subspan(position, static_cast<std::size_t>(size));
+                position += result.size();
+                return result;
+            }
+        };
+
+        // Data bytes of the 4 values of each control byte
+        constexpr std::array<std::uint8_t, 256> makeControlBytes() {
+            std::array<std::uint8_t, 256> result{};
+            for (unsigned control = 0; control < result.size(); control++) {
+                for (unsigned value = 0; value < VALUES_PER_CONTROL; value++) {
+                    result[control] += ((control >> (BITS_PER_LENGTH * value)) & LENGTH_MASK) + 1;
+                }
+            }
+            return result;
+        }
+
+        constexpr std::array<std::uint8_t, 256> CONTROL_BYTES = makeControlBytes();
+
+        // For each control byte, the shuffle that moves the data bytes of its 4 values into 4 little endian
+        // 32-bit lanes; the index 0x80 zeroes the high bytes of the shorter values
+        struct ShuffleTable {
+            alignas(VECTOR_BYTES) std::array<std::array<std::uint8_t, VECTOR_BYTES>, 256> masks{};
+
+            constexpr ShuffleTable() {
+                const std::uint8_t zero = 0x80;
+                for (unsigned control = 0; control < masks.size(); control++) {
+                    unsigned offset = 0;
+                    for (unsigned value = 0; value < VALUES_PER_CONTROL; value++) {
+                        unsigned length = ((control >> (BITS_PER_LENGTH * value)) & LENGTH_MASK) + 1;
+                        for (unsigned byte = 0; byte < sizeof(std::uint32_t); byte++) {
+                            masks[control][value * sizeof(std::uint32_t) + byte] =
+                                    byte < length ? static_cast<std::uint8_t>(offset + byte) : zero;
+                        }
+                        offset += length;
+                    }
+                }
+            }
+        };
+
+        constexpr ShuffleTable SHUFFLES;
+
+        // One Stream VByte sequence of count values
+        struct Stream {
+            std::span<const std::uint8_t> controls;
+            std::span<const std::uint8_t> data;
+            std::size_t count;
+        };
+
+        // Reads a sequence and checks that its control bytes describe exactly its data bytes, so the decoders
+        // below never read past the data. The unused lengths of the last control byte must be zero.
+        Stream readStream(Input &input, std::size_t count) {
+            std::uint64_t data_size = input.readVarint();
+            Stream stream{input.take((count + VALUES_PER_CONTROL - 1) / VALUES_PER_CONTROL), {}, count};
+            stream.data = input.take(data_size);
+            std::size_t full_controls = count / VALUES_PER_CONTROL;
+            std::uint64_t total = 0;
+            for (std::size_t i = 0; i < full_controls; i++) {
+                total += CONTROL_BYTES[stream.controls[i]];
+            }
+            if (std::size_t rest = count % VALUES_PER_CONTROL; rest != 0) {
+                unsigned control = stream.controls[full_controls];
+                for (std::size_t value = 0; value < rest; value++) {
+                    total += ((control >> (BITS_PER_LENGTH * value)) & LENGTH_MASK) + 1;
+                }
+                if ((control >> (BITS_PER_LENGTH * rest)) != 0) {
+                    invalidEncoding();
+                }
+            }
+            if (total != data_size) {
+                invalidEncoding();
+            }
+            return stream;
+        }
+
+        // The transforms applied to the decoded values, in scalar and in SSE form
+
+        struct Unzigzag {
+            static int apply(std::uint32_t value) {
+                return static_cast<int>((value >> 1) ^ (std::uint32_t{0} - (value & 1)));
+            }
+
+            FRACTION_SSE4 static __m128i apply(__m128i value) {
+                __m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi32(1)));
+                return _mm_xor_si128(_mm_srli_epi32(value, 1), sign);
+            }
+        };
+
+        // Values stored minus one, a stored 2^31 - 1 or above comes out as zero or negative
+        struct PlusOne {
+            static int apply(std::uint32_t value) {
+                return static_cast<int>(value + 1);
+            }
+
+            FRACTION_SSE4 static __m128i apply(__m128i value) {
+                return _mm_add_epi32(value, _mm_set1_epi32(1));
+            }
+        };
+
+        // Decodes the values from index begin on, which is a multiple of 4, starting at the given data offset.
+        // Returns the smallest transformed value, or minimum if it is smaller.
+        template<typename Transform>
+        int decodeScalar(const Stream &stream, std::size_t begin, std::size_t offset, int *out, int minimum) {
+            const std::uint8_t *data = stream.data.data() + offset;
+            for (std::size_t i = begin; i < stream.count; i++) {
+                unsigned length = ((stream.controls[i / VALUES_PER_CONTROL] >>
+                                    (BITS_PER_LENGTH * (i % VALUES_PER_CONTROL))) & LENGTH_MASK) + 1;
+                std::uint32_t value = 0;
+                for (unsigned byte = 0; byte < length; byte++) {
+                    value |= static_cast<std::uint32_t>(data[byte]) << (8 * byte);
+                }
+                data += length;
+                out[i] = Transform::apply(value);
+                minimum = std::min(minimum, out[i]);
+            }
+            return minimum;
+        }
+
+        // Decodes 4 values per control byte with one unaligned load and one byte shuffle. A load reads 16
+        // bytes while the values may take as few as 4, so the last few values are left to decodeScalar.
+        template<typename Transform>
+        FRACTION_SSE4 int decodeSse(const Stream &stream, int *out) {
+            const std::uint8_t *data = stream.data.data();
+            const std::uint8_t *data_end = data + stream.data.size();
+            __m128i minimum = _mm_set1_epi32(std::numeric_limits<int>::max());
+            std::size_t i = 0;
+            for (; i + VALUES_PER_CONTROL <= stream.count && static_cast<std::size_t>(data_end - data) >= VECTOR_BYTES;
+                   i += VALUES_PER_CONTROL) {
+                std::uint8_t control = stream.controls[i / VALUES_PER_CONTROL];
+                __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+                __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i *>(SHUFFLES.masks[control].data()));
+                __m128i values = Transform::apply(_mm_shuffle_epi8(packed, shuffle));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), values);
+                minimum = _mm_min_epi32(minimum, values);
+                data += CONTROL_BYTES[control];
+            }
+            minimum = _mm_min_epi32(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+            minimum = _mm_min_epi32(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(2, 3, 0, 1)));
+            return decodeScalar<Transform>(stream, i, static_cast<std::size_t>(data - stream.data.data()), out,
+                                           _mm_cvtsi128_si32(minimum));
+        }
+
+        // Decodes a whole sequence with the instruction set picked for FractionVector. AVX2 brings nothing
+        // over SSE here, the shuffle works on 16 bytes at a time either way.
+        template<typename Transform>
+        int decode(const Stream &stream, int *out) {
+            if (FractionVector::simdLevel() == FractionVector::SimdLevel::Scalar) {
+                return decodeScalar<Transform>(stream, 0, 0, out, std::numeric_limits<int>::max());
+            }
+            return decodeSse<Transform>(stream, out);
+        }
+    }
+
+    std::vector<std::uint8_t> encode_fractions(std::span<const Fraction> values, DenominatorCoding coding) {
+        std::vector<std::uint32_t> numerators;
+        std::vector<std::uint32_t> denominators;
+        numerators.reserve(values.size());
+        denominators.reserve(values.size());
+        for (const Fraction &value: values) {
+            numerators.push_back(zigzag(value.getNumerator()));
+            denominators.push_back(static_cast<std::uint32_t>(value.getDenominator()) - 1);
+        }
+        std::vector<std::uint8_t> per_value;
+        if (coding != DenominatorCoding::Runs) {
+            writeStream(per_value, denominators);
+        }
+        std::vector<std::uint8_t> runs;
+        if (coding != DenominatorCoding::PerValue) {
+            // Run lengths are decoded as ints, so longer runs are split
+            const std::uint32_t max_run = std::numeric_limits<int>::max();
+            std::vector<std::uint32_t> run_denominators;
+            std::vector<std::uint32_t> run_lengths;
+            for (std::size_t i = 0; i < denominators.size(); i++) {
+                if (i == 0 || denominators[i] != run_denominators.back() || run_lengths.back() == max_run - 1) {
+                    run_denominators.push_back(denominators[i]);
+                    run_lengths.push_back(0);
+                } else {
+                    run_lengths.back()++;
+                }
+            }
+            writeVarint(runs, run_denominators.size());
+            writeStream(runs, run_denominators);
+            writeStream(runs, run_lengths);
+        }
+        if (coding == DenominatorCoding::Auto) {
+            coding = runs.size() < per_value.size() ? DenominatorCoding::Runs : DenominatorCoding::PerValue;
+        }
+        std::vector<std::uint8_t> out;
+        out.push_back(static_cast<std::uint8_t>(coding));
+        writeVarint(out, values.size());
+        writeStream(out, numerators);
+        const std::vector<std::uint8_t> &tail = coding == DenominatorCoding::Runs ? runs : per_value;
+        out.insert(out.end(), tail.begin(), tail.end());
+        return out;
+    }
+
+    void decode_fractions(std::span<const std::uint8_t> bytes, FractionVector &out) {
+        Input input(bytes);
+        auto coding = static_cast<DenominatorCoding>(input.readByte());
+        if (coding != DenominatorCoding::PerValue && coding != DenominatorCoding::Runs) {
+            invalidEncoding();
+        }
+        // Every numerator takes at least one byte, which bounds the size before anything is allocated
+        std::uint64_t count = input.readVarint();
+        if (count > bytes.size()) {
+            invalidEncoding();
+        }
+        Stream numerators = readStream(input, static_cast<std::size_t>(count));
+        if (coding == DenominatorCoding::PerValue) {
+            Stream denominators = readStream(input, numerators.count);
+            if (!input.atEnd()) {
+                invalidEncoding();
+            }
+            out.resize(numerators.count);
+            if (decode<PlusOne>(denominators, out.denominators()) <= 0) {
+                invalidEncoding();
+            }
+        } else {
+            std::uint64_t run_count = input.readVarint();
+            if (run_count > count) {
+                invalidEncoding();
+            }
+            Stream run_denominators = readStream(input, static_cast<std::size_t>(run_count));
+            Stream run_lengths = readStream(input, run_denominators.count);
+            if (!input.atEnd()) {
+                invalidEncoding();
+            }
+            std::vector<int> denominator_values(run_denominators.count);
+            std::vector<int> length_values(run_lengths.count);
+            if (decode<PlusOne>(run_denominators, denominator_values.data()) <= 0 ||
+                decode<PlusOne>(run_lengths, length_values.data()) <= 0 ||
+                std::accumulate(length_values.begin(), length_values.end(), std::uint64_t{0}) != count) {
+                invalidEncoding();
+            }
+            out.resize(numerators.count);
+            int *denominators = out.denominators();
+            for (std::size_t i = 0; i < denominator_values.size(); i++) {
+                denominators = std::fill_n(denominators, length_values[i], denominator_values[i]);
+            }
+        }
+        decode<Unzigzag>(numerators, out.numerators());
+    }
+
+    std::vector<Fraction> decode_fractions(std::span<const std::uint8_t> bytes) {
+        FractionVector columns;
+        decode_fractions(bytes, columns);
+        std::vector<Fraction> result;
+        result.reserve(columns.size());
+        for (std::size_t i = 0; i < columns.size(); i++) {
+            result.emplace_back(columns.numerators()[i], columns.denominators()[i]);
+        }
+        return result;
+    }
+}
@@ -0,0 +1,48 @@
+//
+// Compact variable-length encoding of int fraction sequences.
+//
+
+#ifndef FRACTION_B_FRACTIONCODEC_HPP
+#define FRACTION_B_FRACTIONCODEC_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Fraction.hpp"
+#include "FractionVector.hpp"
+
+namespace ariel {
+    // The encoding stores each term in as few bytes as its magnitude needs, so small fractions take 2 or 3
+    // bytes instead of 8. The layout:
+    // - a byte holding the DenominatorCoding, then the number of fractions as an LEB128 varint
+    // - the numerators, zigzag encoded so that small negative values stay small
+    // - for PerValue the denominators minus one, for Runs the number of runs as a varint, the run
+    //   denominators minus one and the run lengths minus one
+    // Every sequence of values is stored like Stream VByte: a varint with the size of the data bytes, one
+    // control byte per 4 values holding their lengths (1 to 4 bytes, two bits each) and then the little
+    // endian data bytes of all values. Keeping the lengths apart from the data lets the decoder place 4
+    // values at once with a single byte shuffle.
+    enum class DenominatorCoding {
+        Auto,     // Whichever of the two below is smaller, decided by encoding both
+        PerValue, // One value per fraction
+        Runs      // One denominator and one length per run of equal denominators, for sorted or grouped data
+    };
+
+    // Encodes the fractions, which are already reduced, so decoding restores them exactly
+    std::vector<std::uint8_t> encode_fractions(std::span<const Fraction> values,
+                                               DenominatorCoding coding = DenominatorCoding::Auto);
+
+    // Decodes into the columns of out, replacing its contents. The values are unpacked 4 at a time with SSE
+    // when FractionVector::simdLevel() allows it. The terms are not reduced again: bytes that did not come
+    // from encode_fractions may leave fractions that need FractionVector::reduce().
+    // Throws runtime_error if the bytes are truncated or malformed or hold a denominator outside of the
+    // positive ints.
+    void decode_fractions(std::span<const std::uint8_t> bytes, FractionVector& out);
+
+    // Decodes into Fractions, each one checked and reduced by the Fraction constructor. Throws like the
+    // overload above.
+    std::vector<Fraction> decode_fractions(std::span<const std::uint8_t> bytes);
+}
+
+#endif //FRACTION_B_FRACTIONCODEC_HPP
@@ -0,0 +1,236 @@
+//
+// Expression templates that evaluate a whole int fraction expression with one reduction.
+//
+
+#ifndef FRACTION_B_FRACTIONEXPR_HPP
+#define FRACTION_B_FRACTIONEXPR_HPP
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "BigFraction.hpp"
+#include "CheckedResult.hpp"
+#include "Fraction.hpp"
+
+namespace ariel {
+    namespace detail {
+        // The unreduced value of a subexpression, the denominator is positive
+        struct WideTerms {
+            int128_t numerator;
+            int128_t denominator;
+        };
+
+        constexpr bool fitsInt64(int128_t value) {
+            return value >= std::numeric_limits<std::int64_t>::min() &&
+                   value <= std::numeric_limits<std::int64_t>::max();
+        }
+
+        // Checked 128-bit product, operands that fit in 64 bits skip the slow overflow check
+        constexpr bool multiplyWide(int128_t lhs, int128_t rhs, int128_t& product) {
+            if (fitsInt64(lhs) && fitsInt64(rhs)) {
+                product = lhs * rhs;
+                return true;
+            }
+            return !__builtin_mul_overflow(lhs, rhs, &product);
+        }
+
+        // Checked 128-bit sum or difference
+        constexpr bool addWide(int128_t lhs, int128_t rhs, bool subtract, int128_t& result) {
+            return subtract ? !__builtin_sub_overflow(lhs, rhs, &result) : !__builtin_add_overflow(lhs, rhs, &result);
+        }
+
+        // Sum or difference of two subexpressions. Operands with the same denominator are added directly,
+        // without cross multiplying.
+        constexpr bool addWide(const WideTerms& lhs, const WideTerms& rhs, bool subtract, WideTerms& result) {
+            if (lhs.denominator == rhs.denominator) {
+                result.denominator = lhs.denominator;
+                return addWide(lhs.numerator, rhs.numerator, subtract, result.numerator);
+            }
+            int128_t lhs_scaled = 0;
+            int128_t rhs_scaled = 0;
+            return multiplyWide(lhs.numerator, rhs.denominator, lhs_scaled) &&
+                   multiplyWide(rhs.numerator, lhs.denominator, rhs_scaled) &&
+                   multiplyWide(lhs.denominator, rhs.denominator, result.denominator) &&
+                   addWide(lhs_scaled, rhs_scaled, subtract, result.numerator);
+        }
+
+        // The operations of the expression tree. apply works on unreduced 128-bit terms and returns false
+        // when they overflow, applyBig is the exact fallback.
+        struct AddOperation {
+            static constexpr bool apply(const WideTerms& lhs, const WideTerms& rhs, WideTerms& result) {
+                return addWide(lhs, rhs, false, result);
+            }
+
+            static BigFraction applyBig(const BigFraction& lhs, const BigFraction& rhs) { return lhs + rhs; }
+        };
+
+        struct SubtractOperation {
+            static constexpr bool apply(const WideTerms& lhs, const WideTerms& rhs, WideTerms& result) {
+                return addWide(lhs, rhs, true, result);
+            }
+
+            static BigFraction applyBig(const BigFraction& lhs, const BigFraction& rhs) { return lhs - rhs; }
+        };
+
+        struct MultiplyOperation {
+            static constexpr bool apply(const WideTerms& lhs, const WideTerms& rhs, WideTerms& result) {
+                return multiplyWide(lhs.numerator, rhs.numerator, result.numerator) &&
+                       multiplyWide(lhs.denominator, rhs.denominator, result.denominator);
+            }
+
+            static BigFraction applyBig(const BigFraction& lhs, const BigFraction& rhs) { return lhs * rhs; }
+        };
+
+        // Throws runtime_error if dividing by zero
+        struct DivideOperation {
+            static constexpr bool apply(const WideTerms& lhs, const WideTerms& rhs, WideTerms& result) {
+                if (rhs.numerator == 0) {
+                    throwFractionError(FractionError::DivisionByZero);
+                }
+                // Negating the minimum value overflows, leave it to the fallback
+                if (rhs.numerator == FractionTraits<int128_t>::min()) {
+                    return false;
+                }
+                // The divisor's sign moves to the numerator, so the denominator stays positive
+                int128_t divisor_numerator = rhs.numerator < 0 ? -rhs.denominator : rhs.denominator;
+                int128_t divisor_denominator = rhs.numerator < 0 ? -rhs.numerator : rhs.numerator;
+                return multiplyWide(lhs.numerator, divisor_numerator, result.numerator) &&
+                       multiplyWide(lhs.denominator, divisor_denominator, result.denominator);
+            }
+
+            static BigFraction applyBig(const BigFraction& lhs, const BigFraction& rhs) { return lhs / rhs; }
+        };
+
+        // A Fraction operand
+        struct ExprLeaf {
+            Fraction value;
+
+            constexpr bool evaluate(WideTerms& result) const {
+                result = {value.getNumerator(), value.getDenominator()};
+                return true;
+            }
+
+            BigFraction evaluateBig() const { return BigFraction(value); }
+        };
+
+        // An operation on two subexpressions
+        template<typename Operation, typename Lhs, typename Rhs>
+        struct ExprNode {
+            Lhs lhs;
+            Rhs rhs;
+
+            constexpr bool evaluate(WideTerms& result) const {
+                WideTerms lhs_terms{};
+                WideTerms rhs_terms{};
+                return lhs.evaluate(lhs_terms) && rhs.evaluate(rhs_terms) &&
+                       Operation::apply(lhs_terms, rhs_terms, result);
+            }
+
+            BigFraction evaluateBig() const { return Operation::applyBig(lhs.evaluateBig(), rhs.evaluateBig()); }
+        };
+    }
+
+    // A fraction expression whose tree is part of its type. Nothing is computed until it is converted to a
+    // Fraction: the whole tree is then evaluated on unreduced 128-bit terms, operands with a common
+    // denominator are added without cross multiplying, and the result is reduced once. If an intermediate
+    // value outgrows 128 bits the tree is evaluated again with BigFraction, so the result is exact
+    // whenever it fits in a Fraction. Like the Fraction operators, the conversion throws overflow_error if
+    // the reduced result does not fit and runtime_error on division by zero. Intermediate values may leave
+    // the int range.
+    template<typename Node>
+    class FractionExpr {
+    private:
+        Node node;
+
+    public:
+        constexpr explicit FractionExpr(Node node) : node(node) {}
+
+        constexpr const Node& tree() const { return node; }
+
+        constexpr Fraction evaluate() const {
+            detail::WideTerms result{};
+            if (!node.evaluate(result)) {
+                return node.evaluateBig().toFraction();
+            }
+            int128_t numerator = result.numerator;
+            int128_t denominator = result.denominator;
+            auto fitsInt = [](int128_t value) {
+                return value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max();
+            };
+            if (!fitsInt(numerator) || !fitsInt(denominator)) {
+                // Reduced here first, small terms are reduced by try_make
+                int128_t gcd = FractionTraits<int128_t>::gcd(numerator, denominator);
+                numerator /= gcd;
+                denominator /= gcd;
+                if (!fitsInt(numerator) || !fitsInt(denominator)) {
+                    throwFractionError(FractionError::Overflow);
+                }
+            }
+            return *Fraction::try_make(static_cast<int>(numerator), static_cast<int>(denominator));
+        }
+
+        // Existing code that stores a Fraction keeps working
+        constexpr operator Fraction() const { return evaluate(); }
+    };
+
+    // Starts an expression: expr(a) + b - 1 builds the tree and evaluates it once, when it is converted
+    constexpr FractionExpr<detail::ExprLeaf> expr(const Fraction& value) {
+        return FractionExpr<detail::ExprLeaf>(detail::ExprLeaf{value});
+    }
+
+    namespace detail {
+        template<typename T>
+        constexpr bool isFractionExpr = false;
+
+        template<typename Node>
+        constexpr bool isFractionExpr<FractionExpr<Node>> = true;
+
+        // An expression, a Fraction or an int
+        template<typename T>
+        concept ExprOperand = isFractionExpr<T> || std::is_same_v<T, Fraction> || std::is_same_v<T, int>;
+
+        // At least one side must already be an expression, so plain Fraction arithmetic is unchanged
+        template<typename Lhs, typename Rhs>
+        concept ExprOperands = ExprOperand<Lhs> && ExprOperand<Rhs> && (isFractionExpr<Lhs> || isFractionExpr<Rhs>);
+
+        template<typename T>
+        constexpr auto exprNode(const T& operand) {
+            if constexpr (isFractionExpr<T>) {
+                return operand.tree();
+            } else if constexpr (std::is_same_v<T, int>) {
+                return ExprLeaf{Fraction(operand, 1)};
+            } else {
+                return ExprLeaf{operand};
+            }
+        }
+
+        template<typename Operation, typename Lhs, typename Rhs>
+        constexpr auto makeExpr(const Lhs& lhs, const Rhs& rhs) {
+            using Node = ExprNode<Operation, decltype(exprNode(lhs)), decltype(exprNode(rhs))>;
+            return FractionExpr<Node>(Node{exprNode(lhs), exprNode(rhs)});
+        }
+    }
+
+    template<typename Lhs, typename Rhs> requires detail::ExprOperands<Lhs, Rhs>
+    constexpr auto operator+(const Lhs& lhs, const Rhs& rhs) {
+        return detail::makeExpr<detail::AddOperation>(lhs, rhs);
+    }
+
+    template<typename Lhs, typename Rhs> requires detail::ExprOperands<Lhs, Rhs>
+    constexpr auto operator-(const Lhs& lhs, const Rhs& rhs) {
+        return detail::makeExpr<detail::SubtractOperation>(lhs, rhs);
+    }
+
+    template<typename Lhs, typename Rhs> requires detail::ExprOperands<Lhs, Rhs>
+    constexpr auto operator*(const Lhs& lhs, const Rhs& rhs) {
+        return detail::makeExpr<detail::MultiplyOperation>(lhs, rhs);
+    }
+
+    template<typename Lhs, typename Rhs> requires detail::ExprOperands<Lhs, Rhs>
+    constexpr auto operator/(const Lhs& lhs, const Rhs& rhs) {
+        return detail::makeExpr<detail::DivideOperation>(lhs, rhs);
+    }
+}
+
+#endif //FRACTION_B_FRACTIONEXPR_HPP
@@ -0,0 +1,229 @@
+//
+// Columnar binary files of int fractions, written in a stream and read through mmap.
+//
+#include "FractionFile.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ColumnBounds.hpp"
+
+namespace ariel {
+
+    // The columns are used in place, so the file byte order must be the native one
+    static_assert(std::endian::native == std::endian::little, "Fraction files are little endian");
+
+    namespace {
+        struct FileHeader {
+            char magic[sizeof(detail::FILE_MAGIC)];
+            std::uint32_t version;
+            std::uint32_t chunk_size;
+            std::uint64_t count;
+            std::uint64_t reserved;
+        };
+
+        struct ChunkHeader {
+            std::uint32_t size;
+            std::uint32_t reserved;
+            std::int32_t min_numerator;
+            std::int32_t max_numerator;
+            std::int32_t min_denominator;
+            std::int32_t max_denominator;
+            std::uint64_t reserved_end;
+        };
+
+        static_assert(sizeof(FileHeader) == detail::FILE_HEADER_BYTES);
+        static_assert(sizeof(ChunkHeader) == detail::CHUNK_HEADER_BYTES);
+
+        // Bytes of a column of size ints, including the padding
+        std::size_t columnBytes(std::size_t size) {
+            std::size_t bytes = size * sizeof(int);
+            return (bytes + detail::COLUMN_ALIGNMENT - 1) / detail::COLUMN_ALIGNMENT * detail::COLUMN_ALIGNMENT;
+        }
+
+        std::size_t chunkBytes(std::size_t size) {
+            return detail::CHUNK_HEADER_BYTES + 2 * columnBytes(size);
+        }
+
+        [[noreturn]] void invalidFile() {
+            throw std::runtime_error("Invalid fraction file");
+        }
+    }
+
+    FractionFileWriter::FractionFileWriter(const std::string &path, std::uint32_t chunk_size) : chunk_size(chunk_size) {
+        if (chunk_size == 0) {
+            throw std::invalid_argument("Chunk size must be positive");
+        }
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Could not open " + path);
+        }
+        numerators.reserve(chunk_size);
+        denominators.reserve(chunk_size);
+        writeHeader();
+    }
+
+    FractionFileWriter::~FractionFileWriter() {
+        if (!closed) {
+            try {
+                close();
+            } catch (const std::exception &) {
+                // A destructor can't report the error, call close() to see it
+            }
+        }
+    }
+
+    void FractionFileWriter::writeHeader() {
+        FileHeader header{};
+        std::memcpy(header.magic, detail::FILE_MAGIC, sizeof(header.magic));
+        header.version = detail::FILE_VERSION;
+        header.chunk_size = chunk_size;
+        header.count = count;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+
+    void FractionFileWriter::writeChunk() {
+        static const char padding[detail::COLUMN_ALIGNMENT] = {};
+        auto [min_numerator, max_numerator] = std::minmax_element(numerators.begin(), numerators.end());
+        auto [min_denominator, max_denominator] = std::minmax_element(denominators.begin(), denominators.end());
+        ChunkHeader header{};
+        header.size = static_cast<std::uint32_t>(numerators.size());
+        header.min_numerator = *min_numerator;
+        header.max_numerator = *max_numerator;
+        header.min_denominator = *min_denominator;
+        header.max_denominator = *max_denominator;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        std::size_t bytes = numerators.size() * sizeof(int);
+        auto padding_bytes = static_cast<std::streamsize>(columnBytes(numerators.size()) - bytes);
+        out.write(reinterpret_cast<const char *>(numerators.data()), static_cast<std::streamsize>(bytes));
+        out.write(padding, padding_bytes);
+        out.write(reinterpret_cast<const char *>(denominators.data()), static_cast<std::streamsize>(bytes));
+        out.write(padding, padding_bytes);
+        if (!out) {
+            throw std::runtime_error("Could not write fraction file");
+        }
+        numerators.clear();
+        denominators.clear();
+    }
+
+    void FractionFileWriter::write(const Fraction &fraction) {
+        numerators.push_back(fraction.getNumerator());
+        denominators.push_back(fraction.getDenominator());
+        count++;
+        if (numerators.size() == chunk_size) {
+            writeChunk();
+        }
+    }
+
+    void FractionFileWriter::write(std::span<const Fraction> fractions) {
+        for (const Fraction &fraction: fractions) {
+            write(fraction);
+        }
+    }
+
+    void FractionFileWriter::close() {
+        if (closed) {
+            throw std::runtime_error("Fraction file already closed");
+        }
+        closed = true;
+        if (!numerators.empty()) {
+            writeChunk();
+        }
+        out.seekp(0);
+        writeHeader();
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Could not write fraction file");
+        }
+    }
+
+    FractionFileReader::FractionFileReader(const std::string &path) {
+        int descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error("Could not open " + path);
+        }
+        struct stat status{};
+        if (::fstat(descriptor, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(FileHeader)) {
+            ::close(descriptor);
+            invalidFile();
+        }
+        bytes = static_cast<std::size_t>(status.st_size);
+        void *mapping = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        // The mapping stays valid after the descriptor is closed
+        ::close(descriptor);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Could not map " + path);
+        }
+        data = static_cast<const std::byte *>(mapping);
+        try {
+            FileHeader header{};
+            std::memcpy(&header, data, sizeof(header));
+            if (std::memcmp(header.magic, detail::FILE_MAGIC, sizeof(header.magic)) != 0 ||
+                header.version != detail::FILE_VERSION || header.chunk_size == 0 ||
+                header.count > bytes / (2 * sizeof(int))) {
+                invalidFile();
+            }
+            chunk_size = header.chunk_size;
+            count = header.count;
+            chunk_count = static_cast<std::size_t>((count + chunk_size - 1) / chunk_size);
+            // Every full chunk must fit, which also keeps the offsets below from overflowing
+            if (chunk_count > 1 && chunkBytes(chunk_size) > bytes) {
+                invalidFile();
+            }
+            std::size_t last_size = count - (chunk_count == 0 ? 0 : (chunk_count - 1) * std::uint64_t{chunk_size});
+            std::size_t expected = chunk_count == 0 ? sizeof(FileHeader) : chunkOffset(chunk_count - 1) +
+                                                                             chunkBytes(last_size);
+            if (bytes != expected) {
+                invalidFile();
+            }
+            for (std::size_t i = 0; i < chunk_count; i++) {
+                ChunkHeader chunk_header{};
+                std::memcpy(&chunk_header, data + chunkOffset(i), sizeof(chunk_header));
+                if (chunk_header.size != (i + 1 == chunk_count ? last_size : chunk_size) ||
+                    chunk_header.min_denominator < 1 || chunk_header.min_numerator > chunk_header.max_numerator ||
+                    chunk_header.min_denominator > chunk_header.max_denominator) {
+                    invalidFile();
+                }
+            }
+        } catch (...) {
+            ::munmap(mapping, bytes);
+            throw;
+        }
+    }
+
+    FractionFileReader::~FractionFileReader() {
+        ::munmap(const_cast<std::byte *>(data), bytes);
+    }
+
+    // Every chunk before the given one is full
+    std::size_t FractionFileReader::chunkOffset(std::size_t index) const {
+        return sizeof(FileHeader) + index * chunkBytes(chunk_size);
+    }
+
+    FractionChunk FractionFileReader::chunk(std::size_t index) const {
+        if (index >= chunk_count) {
+            throw std::out_of_range("No such chunk");
+        }
+        const std::byte *start = data + chunkOffset(index);
+        ChunkHeader header{};
+        std::memcpy(&header, start, sizeof(header));
+        // The mapping is page aligned and every column starts at a multiple of 32 bytes
+        const auto *numerators = reinterpret_cast<const int *>(start + sizeof(header));
+        const auto *denominators = reinterpret_cast<const int *>(start + sizeof(header) + columnBytes(header.size));
+        FractionChunk result{{numerators, header.size}, {denominators, header.size}, header.min_numerator,
+                             header.max_numerator, header.min_denominator, header.max_denominator};
+        // Opening checked that min_denominator is positive, so this also rules out zero and negative denominators
+        if (!detail::withinBounds(result.numerators, result.min_numerator, result.max_numerator) ||
+            !detail::withinBounds(result.denominators, result.min_denominator, result.max_denominator)) {
+            invalidFile();
+        }
+        return result;
+    }
+}
@@ -0,0 +1,120 @@
+//
+// Columnar binary files of int fractions, written in a stream and read through mmap.
+//
+
+#ifndef FRACTION_B_FRACTIONFILE_HPP
+#define FRACTION_B_FRACTIONFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Fraction.hpp"
+
+namespace ariel {
+    // The file format, all values little endian:
+    // - a 32 byte header: the magic "FRACCOL" with a zero byte, the uint32 version, the uint32 chunk size,
+    //   the uint64 number of fractions and 8 reserved bytes
+    // - the chunks, each of chunk size fractions except the last one: a 32 byte chunk header holding the
+    //   uint32 number of fractions, 4 reserved bytes, the int32 minimum and maximum numerator and
+    //   denominator and 8 reserved bytes, then the int32 numerators and the int32 denominators. Each
+    //   column is padded to a multiple of 32 bytes, so that the columns are aligned for vector loads.
+    // The fractions are stored reduced, with positive denominators.
+    namespace detail {
+        constexpr char FILE_MAGIC[8] = {'F', 'R', 'A', 'C', 'C', 'O', 'L', '\0'};
+        constexpr std::uint32_t FILE_VERSION = 1;
+        constexpr std::size_t FILE_HEADER_BYTES = 32;
+        constexpr std::size_t CHUNK_HEADER_BYTES = 32;
+        constexpr std::size_t COLUMN_ALIGNMENT = 32;
+    }
+
+    // One chunk of a file, the columns point straight into the mapped file
+    struct FractionChunk {
+        std::span<const int> numerators;
+        std::span<const int> denominators; // Always positive
+        int min_numerator;
+        int max_numerator;
+        int min_denominator;
+        int max_denominator;
+
+        std::size_t size() const { return numerators.size(); }
+
+        Fraction operator[](std::size_t index) const { return Fraction(numerators[index], denominators[index]); }
+    };
+
+    // Writes fractions to a file one chunk at a time, so only one chunk is ever held in memory. The header
+    // is completed by close(); a file that was never closed has no fractions.
+    class FractionFileWriter {
+    private:
+        std::ofstream out;
+        std::uint32_t chunk_size;
+        std::uint64_t count = 0;
+        std::vector<int> numerators;
+        std::vector<int> denominators;
+        bool closed = false;
+
+        void writeHeader();
+        void writeChunk();
+
+    public:
+        static constexpr std::uint32_t DEFAULT_CHUNK_SIZE = 1 << 16;
+
+        // Creates or truncates the file. Throws invalid_argument for a zero chunk size and runtime_error if the
+        // file can't be opened.
+        explicit FractionFileWriter(const std::string& path, std::uint32_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+        // Closes the file if close() was not called, ignoring errors
+        ~FractionFileWriter();
+
+        FractionFileWriter(const FractionFileWriter&) = delete;
+
+        FractionFileWriter& operator=(const FractionFileWriter&) = delete;
+
+        void write(const Fraction& fraction);
+
+        void write(std::span<const Fraction> fractions);
+
+        // Writes the last chunk and the header. Throws runtime_error if writing fails or the file is closed.
+        void close();
+    };
+
+    // Maps a file written by FractionFileWriter into memory. Nothing is copied or parsed: the chunks are
+    // views of the mapped pages, which the operating system reads in as they are touched. Opening checks
+    // the header and the chunk headers; the columns of a chunk are checked against its recorded minimum
+    // and maximum when chunk() returns it, so its denominators are always positive.
+    class FractionFileReader {
+    private:
+        const std::byte* data = nullptr;
+        std::size_t bytes = 0;
+        std::uint32_t chunk_size = 0;
+        std::uint64_t count = 0;
+        std::size_t chunk_count = 0;
+
+        // Offset of a chunk from the start of the file
+        std::size_t chunkOffset(std::size_t index) const;
+
+    public:
+        // Throws runtime_error if the file can't be opened or is not a valid fraction file
+        explicit FractionFileReader(const std::string& path);
+
+        ~FractionFileReader();
+
+        FractionFileReader(const FractionFileReader&) = delete;
+
+        FractionFileReader& operator=(const FractionFileReader&) = delete;
+
+        // Number of fractions in the file
+        std::uint64_t size() const { return count; }
+
+        std::size_t chunkCount() const { return chunk_count; }
+
+        // Throws out_of_range if there is no such chunk and runtime_error if a value of the chunk lies outside
+        // of the recorded bounds
+        FractionChunk chunk(std::size_t index) const;
+    };
+}
+
+#endif //FRACTION_B_FRACTIONFILE_HPP
@@ -0,0 +1,299 @@
+//
+// Flat open addressing hash containers keyed by int fractions.
+//
+
+#ifndef FRACTION_B_FRACTIONHASHMAP_HPP
+#define FRACTION_B_FRACTIONHASHMAP_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Fraction.hpp"
+#include "Hash.hpp"
+
+namespace ariel {
+    namespace detail {
+        static_assert(std::is_trivially_copyable_v<Fraction> && sizeof(Fraction) == sizeof(std::uint64_t),
+                      "A Fraction key is stored as its 8 bytes");
+
+        // The keys of FractionHashMap and FractionHashSet: linear probing over a power of two array of
+        // fractions stored as their 8 bytes. No fraction has a zero denominator, so the word 0 marks an
+        // empty slot and no separate metadata is needed. The containers keep their values in a parallel
+        // array and are told through a relocate(from, to) callback whenever a key moves.
+        class FractionKeyTable {
+        public:
+            static constexpr std::size_t NOT_FOUND = std::numeric_limits<std::size_t>::max();
+            static constexpr std::uint64_t EMPTY = 0;
+
+            static std::uint64_t pack(const Fraction& fraction) { return std::bit_cast<std::uint64_t>(fraction); }
+
+            static Fraction unpack(std::uint64_t key) { return std::bit_cast<Fraction>(key); }
+
+            std::size_t size() const { return count; }
+
+            std::size_t capacity() const { return keys.size(); }
+
+            std::uint64_t keyAt(std::size_t slot) const { return keys[slot]; }
+
+            // The slot holding key, or NOT_FOUND
+            std::size_t find(std::uint64_t key) const {
+                if (keys.empty()) {
+                    return NOT_FOUND;
+                }
+                for (std::size_t slot = mixBits(key) & mask;; slot = (slot + 1) & mask) {
+                    if (keys[slot] == key) {
+                        return slot;
+                    }
+                    if (keys[slot] == EMPTY) {
+                        return NOT_FOUND;
+                    }
+                }
+            }
+
+            // Capacity needed before one more key can be inserted, or 0 if the table has room
+            std::size_t capacityForInsert() const {
+                if ((count + 1) * MAX_LOAD_DENOMINATOR <= keys.size() * MAX_LOAD_NUMERATOR) {
+                    return 0;
+                }
+                return capacityFor(count + 1);
+            }
+
+            // Smallest capacity holding size keys within the maximum load factor
+            static std::size_t capacityFor(std::size_t size) {
+                std::size_t capacity = MIN_CAPACITY;
+                while (size * MAX_LOAD_DENOMINATOR > capacity * MAX_LOAD_NUMERATOR) {
+                    capacity *= 2;
+                }
+                return capacity;
+            }
+
+            // Returns the slot of key and true if it was inserted, false if it was already there.
+            // The table must have room, see capacityForInsert.
+            std::pair<std::size_t, bool> insert(std::uint64_t key) {
+                std::size_t slot = mixBits(key) & mask;
+                while (keys[slot] != EMPTY) {
+                    if (keys[slot] == key) {
+                        return {slot, false};
+                    }
+                    slot = (slot + 1) & mask;
+                }
+                keys[slot] = key;
+                count++;
+                return {slot, true};
+            }
+
+            // Moves every key to a table of the given power of two capacity
+            template<typename Relocate>
+            void rehash(std::size_t new_capacity, Relocate relocate) {
+                std::vector<std::uint64_t> old_keys(new_capacity, EMPTY);
+                old_keys.swap(keys);
+                mask = new_capacity - 1;
+                for (std::size_t from = 0; from < old_keys.size(); from++) {
+                    if (old_keys[from] != EMPTY) {
+                        std::size_t to = mixBits(old_keys[from]) & mask;
+                        while (keys[to] != EMPTY) {
+                            to = (to + 1) & mask;
+                        }
+                        keys[to] = old_keys[from];
+                        relocate(from, to);
+                    }
+                }
+            }
+
+            // Removes the key in slot by shifting the following keys of its probe sequence back, so that no
+            // tombstones are needed. Returns the slot that ends up empty.
+            template<typename Relocate>
+            std::size_t erase(std::size_t slot, Relocate relocate) {
+                std::size_t hole = slot;
+                for (std::size_t next = (hole + 1) & mask; keys[next] != EMPTY; next = (next + 1) & mask) {
+                    // The key can fill the hole if its home slot is not between the hole and its position
+                    std::size_t home = mixBits(keys[next]) & mask;
+                    if (((next - home) & mask) >= ((next - hole) & mask)) {
+                        keys[hole] = keys[next];
+                        relocate(next, hole);
+                        hole = next;
+                    }
+                }
+                keys[hole] = EMPTY;
+                count--;
+                return hole;
+            }
+
+            // Removes all keys, the capacity is kept
+            void clear() {
+                std::fill(keys.begin(), keys.end(), EMPTY);
+                count = 0;
+            }
+
+        private:
+            // At most 3/4 of the slots are used, which keeps the probe sequences short
+            static constexpr std::size_t MAX_LOAD_NUMERATOR = 3;
+            static constexpr std::size_t MAX_LOAD_DENOMINATOR = 4;
+            static constexpr std::size_t MIN_CAPACITY = 16;
+
+            std::vector<std::uint64_t> keys; // Packed fractions, EMPTY for free slots
+            std::size_t count = 0;           // Number of keys
+            std::size_t mask = 0;            // Capacity minus one
+        };
+    }
+
+    // Hash map from Fraction to V with open addressing. The 8-byte keys are probed in their own array and
+    // the values live in a parallel array, so a lookup only touches one value. Unused slots hold default
+    // constructed values, so V must be default constructible. Inserting or erasing invalidates pointers
+    // to values.
+    template<typename V>
+    class FractionHashMap {
+    private:
+        detail::FractionKeyTable table;
+        std::vector<V> values;
+
+        void rehash(std::size_t capacity) {
+            std::vector<V> moved(capacity);
+            table.rehash(capacity, [&](std::size_t from, std::size_t to) { moved[to] = std::move(values[from]); });
+            values.swap(moved);
+        }
+
+        // The slot of key, inserting it with a default value if it is absent
+        std::pair<std::size_t, bool> emplaceKey(const Fraction& key) {
+            std::size_t capacity = table.capacityForInsert();
+            if (capacity != 0) {
+                rehash(capacity);
+            }
+            return table.insert(detail::FractionKeyTable::pack(key));
+        }
+
+    public:
+        std::size_t size() const { return table.size(); }
+
+        bool empty() const { return table.size() == 0; }
+
+        // Makes room for size keys without rehashing
+        void reserve(std::size_t size) {
+            std::size_t capacity = detail::FractionKeyTable::capacityFor(size);
+            if (capacity > table.capacity()) {
+                rehash(capacity);
+            }
+        }
+
+        // Removes all entries, the capacity is kept
+        void clear() {
+            table.clear();
+            std::fill(values.begin(), values.end(), V());
+        }
+
+        // Returns the value of key, inserting a default value if it is absent
+        V& operator[](const Fraction& key) { return values[emplaceKey(key).first]; }
+
+        // Inserts the entry if key is absent, returns false and leaves the map unchanged otherwise
+        bool insert(const Fraction& key, V value) {
+            auto [slot, inserted] = emplaceKey(key);
+            if (inserted) {
+                values[slot] = std::move(value);
+            }
+            return inserted;
+        }
+
+        // Returns the value of key, or nullptr if it is absent
+        V* find(const Fraction& key) {
+            std::size_t slot = table.find(detail::FractionKeyTable::pack(key));
+            return slot == detail::FractionKeyTable::NOT_FOUND ? nullptr : &values[slot];
+        }
+
+        const V* find(const Fraction& key) const {
+            std::size_t slot = table.find(detail::FractionKeyTable::pack(key));
+            return slot == detail::FractionKeyTable::NOT_FOUND ? nullptr : &values[slot];
+        }
+
+        bool contains(const Fraction& key) const {
+            return table.find(detail::FractionKeyTable::pack(key)) != detail::FractionKeyTable::NOT_FOUND;
+        }
+
+        // Removes the entry of key, returns false if there is none
+        bool erase(const Fraction& key) {
+            std::size_t slot = table.find(detail::FractionKeyTable::pack(key));
+            if (slot == detail::FractionKeyTable::NOT_FOUND) {
+                return false;
+            }
+            std::size_t emptied = table.erase(slot, [&](std::size_t from, std::size_t to) {
+                values[to] = std::move(values[from]);
+            });
+            values[emptied] = V();
+            return true;
+        }
+
+        // Calls visitor(key, value) for every entry, in no particular order
+        template<typename Visitor>
+        void for_each(Visitor visitor) const {
+            for (std::size_t slot = 0; slot < table.capacity(); slot++) {
+                if (table.keyAt(slot) != detail::FractionKeyTable::EMPTY) {
+                    visitor(detail::FractionKeyTable::unpack(table.keyAt(slot)), values[slot]);
+                }
+            }
+        }
+    };
+
+    // Hash set of Fractions with open addressing over the 8-byte keys, see FractionHashMap
+    class FractionHashSet {
+    private:
+        detail::FractionKeyTable table;
+
+        static void ignoreMove(std::size_t /*from*/, std::size_t /*to*/) {}
+
+    public:
+        std::size_t size() const { return table.size(); }
+
+        bool empty() const { return table.size() == 0; }
+
+        // Makes room for size keys without rehashing
+        void reserve(std::size_t size) {
+            std::size_t capacity = detail::FractionKeyTable::capacityFor(size);
+            if (capacity > table.capacity()) {
+                table.rehash(capacity, ignoreMove);
+            }
+        }
+
+        // Removes all keys, the capacity is kept
+        void clear() { table.clear(); }
+
+        // Inserts key, returns false if it was already there
+        bool insert(const Fraction& key) {
+            std::size_t capacity = table.capacityForInsert();
+            if (capacity != 0) {
+                table.rehash(capacity, ignoreMove);
+            }
+            return table.insert(detail::FractionKeyTable::pack(key)).second;
+        }
+
+        bool contains(const Fraction& key) const {
+            return table.find(detail::FractionKeyTable::pack(key)) != detail::FractionKeyTable::NOT_FOUND;
+        }
+
+        // Removes key, returns false if it is absent
+        bool erase(const Fraction& key) {
+            std::size_t slot = table.find(detail::FractionKeyTable::pack(key));
+            if (slot == detail::FractionKeyTable::NOT_FOUND) {
+                return false;
+            }
+            table.erase(slot, ignoreMove);
+            return true;
+        }
+
+        // Calls visitor(key) for every key, in no particular order
+        template<typename Visitor>
+        void for_each(Visitor visitor) const {
+            for (std::size_t slot = 0; slot < table.capacity(); slot++) {
+                if (table.keyAt(slot) != detail::FractionKeyTable::EMPTY) {
+                    visitor(detail::FractionKeyTable::unpack(table.keyAt(slot)));
+                }
+            }
+        }
+    };
+}
+
+#endif //FRACTION_B_FRACTIONHASHMAP_HPP
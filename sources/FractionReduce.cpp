@@ -0,0 +1,93 @@
+//
+// Exact sums, dot products and means of int fraction arrays.
+//
+#include "FractionReduce.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "ColumnBounds.hpp"
+#include "Parallel.hpp"
+#include "WideSum.hpp"
+
+namespace ariel {
+
+    namespace {
+        const unsigned MAX_WORKERS = 256;
+
+        // Adds the partial sums pairwise, so that the operands of each addition have similar sizes
+        BigFraction addPairwise(std::vector<BigFraction> partials) {
+            for (std::size_t step = 1; step < partials.size(); step *= 2) {
+                for (std::size_t i = 0; i + step < partials.size(); i += 2 * step) {
+                    partials[i] += partials[i + step];
+                }
+            }
+            return partials.front();
+        }
+
+        // Splits [0, size) into one chunk per worker, calls addRange(accumulator, begin, end) for every chunk and
+        // adds up the results
+        template<typename AddRange>
+        BigFraction reduce(std::size_t size, ReduceOptions options, AddRange addRange) {
+            unsigned workers = 1;
+            if (size >= detail::PARALLEL_THRESHOLD) {
+                workers = detail::workerCount(options.threads, MAX_WORKERS);
+            }
+            std::vector<BigFraction> partials(workers);
+            detail::runParallel(workers, [&](unsigned worker) {
+                detail::WideSum accumulator;
+                addRange(accumulator, detail::chunkBegin(size, workers, worker),
+                         detail::chunkBegin(size, workers, worker + 1));
+                partials[worker] = accumulator.result();
+            });
+            return addPairwise(std::move(partials));
+        }
+    }
+
+    BigFraction sum(std::span<const Fraction> values, ReduceOptions options) {
+        return reduce(values.size(), options, [&](detail::WideSum &accumulator, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                accumulator.add(values[i].getNumerator(), static_cast<std::uint64_t>(values[i].getDenominator()));
+            }
+        });
+    }
+
+    BigFraction sum(std::span<const int> numerators, std::span<const int> denominators, ReduceOptions options) {
+        if (numerators.size() != denominators.size()) {
+            throw std::invalid_argument("Sum of columns of different sizes");
+        }
+        // The columns may come from a file or from raw writes, and WideSum needs positive denominators
+        if (!detail::withinBounds(denominators, 1, std::numeric_limits<int>::max())) {
+            throw std::invalid_argument("Denominators must be positive");
+        }
+        auto addRange = [&](detail::WideSum &accumulator, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                accumulator.add(numerators[i], static_cast<std::uint64_t>(denominators[i]));
+            }
+        };
+        return reduce(numerators.size(), options, addRange);
+    }
+
+    BigFraction dot(std::span<const Fraction> lhs, std::span<const Fraction> rhs, ReduceOptions options) {
+        if (lhs.size() != rhs.size()) {
+            throw std::invalid_argument("Dot product of ranges of different sizes");
+        }
+        return reduce(lhs.size(), options, [&](detail::WideSum &accumulator, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                // Both products are at most 2^62 in magnitude
+                std::int64_t numerator = std::int64_t{lhs[i].getNumerator()} * rhs[i].getNumerator();
+                std::int64_t denominator = std::int64_t{lhs[i].getDenominator()} * rhs[i].getDenominator();
+                accumulator.add(numerator, static_cast<std::uint64_t>(denominator));
+            }
+        });
+    }
+
+    BigFraction mean(std::span<const Fraction> values, ReduceOptions options) {
+        if (values.empty()) {
+            throw std::invalid_argument("Mean of an empty range");
+        }
+        return sum(values, options) / BigFraction(BigInteger(values.size()), BigInteger(1));
+    }
+}
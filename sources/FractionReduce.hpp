@@ -0,0 +1,37 @@
+//
+// Exact sums, dot products and means of int fraction arrays.
+//
+
+#ifndef FRACTION_B_FRACTIONREDUCE_HPP
+#define FRACTION_B_FRACTIONREDUCE_HPP
+
+#include <span>
+
+#include "BigFraction.hpp"
+#include "Fraction.hpp"
+
+namespace ariel {
+    // How the reductions split their work
+    struct ReduceOptions {
+        // Worker threads for inputs of 64K elements or more, 0 for one per hardware thread
+        unsigned threads = 0;
+    };
+
+    // Exact sum of the fractions, never overflows. Each worker adds its chunk into a 128-bit numerator over
+    // the lcm of the denominators seen so far, without reducing; only when that would overflow is the
+    // pending sum moved into a BigFraction. The partial sums of the workers are added pairwise and the
+    // result is reduced once at the end.
+    BigFraction sum(std::span<const Fraction> values, ReduceOptions options = {});
+
+    // Exact sum of numerators[i] / denominators[i], for fractions stored as columns like those of FractionVector
+    // and FractionChunk. Throws invalid_argument if the sizes differ or a denominator is not positive.
+    BigFraction sum(std::span<const int> numerators, std::span<const int> denominators, ReduceOptions options = {});
+
+    // Exact sum of lhs[i] * rhs[i], computed like sum. Throws invalid_argument if the sizes differ.
+    BigFraction dot(std::span<const Fraction> lhs, std::span<const Fraction> rhs, ReduceOptions options = {});
+
+    // Exact arithmetic mean, throws invalid_argument if there are no values
+    BigFraction mean(std::span<const Fraction> values, ReduceOptions options = {});
+}
+
+#endif //FRACTION_B_FRACTIONREDUCE_HPP
@@ -0,0 +1,140 @@
+//
+// Sorting and selection of int fraction arrays with exact comparison.
+//
+#include "FractionSort.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Parallel.hpp"
+
+namespace ariel {
+
+    namespace {
+        // Sample elements taken per bucket, more samples give more even buckets
+        const std::size_t OVERSAMPLING = 64;
+
+        // Bucket indexes are stored in one byte per element
+        const unsigned MAX_WORKERS = 256;
+
+        // A fraction with its value rounded to a double. Rounding is monotonic, so a smaller key means a
+        // smaller fraction and only equal keys need the exact comparison.
+        struct KeyedFraction {
+            double key;
+            Fraction value;
+        };
+
+        struct ExactLess {
+            bool operator()(const Fraction &lhs, const Fraction &rhs) const {
+                return lhs < rhs;
+            }
+        };
+
+        struct KeyedLess {
+            bool operator()(const KeyedFraction &lhs, const KeyedFraction &rhs) const {
+                return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.value < rhs.value);
+            }
+        };
+
+        template<typename T, typename Less>
+        void sampleSort(std::span<T> values, unsigned workers, Less less) {
+            std::size_t size = values.size();
+            if (workers <= 1 || size < detail::PARALLEL_THRESHOLD) {
+                std::sort(values.begin(), values.end(), less);
+                return;
+            }
+            // Splitters from a sorted sample spread evenly over the input, bucket b gets the elements between
+            // splitters b - 1 and b
+            std::size_t sample_size = workers * OVERSAMPLING;
+            std::size_t stride = size / sample_size;
+            std::vector<T> sample;
+            sample.reserve(sample_size);
+            for (std::size_t i = 0; i < sample_size; i++) {
+                sample.push_back(values[i * stride + stride / 2]);
+            }
+            std::sort(sample.begin(), sample.end(), less);
+            std::vector<T> splitters;
+            for (unsigned bucket = 1; bucket < workers; bucket++) {
+                splitters.push_back(sample[bucket * OVERSAMPLING]);
+            }
+
+            // Every worker classifies one chunk of the input and counts the elements of each bucket
+            auto chunkBegin = [&](unsigned worker) { return detail::chunkBegin(size, workers, worker); };
+            std::vector<std::uint8_t> buckets(size);
+            std::vector<std::vector<std::size_t>> counts(workers, std::vector<std::size_t>(workers, 0));
+            detail::runParallel(workers, [&](unsigned worker) {
+                for (std::size_t i = chunkBegin(worker); i < chunkBegin(worker + 1); i++) {
+                    auto bucket = static_cast<std::size_t>(
+                            std::upper_bound(splitters.begin(), splitters.end(), values[i], less) - splitters.begin());
+                    buckets[i] = static_cast<std::uint8_t>(bucket);
+                    counts[worker][bucket]++;
+                }
+            });
+
+            // Each worker writes its share of a bucket after the shares of the workers before it
+            std::vector<std::size_t> bucket_begin(workers + 1, 0);
+            std::vector<std::vector<std::size_t>> offsets(workers, std::vector<std::size_t>(workers, 0));
+            std::size_t offset = 0;
+            for (unsigned bucket = 0; bucket < workers; bucket++) {
+                bucket_begin[bucket] = offset;
+                for (unsigned worker = 0; worker < workers; worker++) {
+                    offsets[worker][bucket] = offset;
+                    offset += counts[worker][bucket];
+                }
+            }
+            bucket_begin[workers] = size;
+
+            std::vector<T> scattered(size);
+            detail::runParallel(workers, [&](unsigned worker) {
+                std::vector<std::size_t> &next = offsets[worker];
+                for (std::size_t i = chunkBegin(worker); i < chunkBegin(worker + 1); i++) {
+                    scattered[next[buckets[i]]++] = values[i];
+                }
+            });
+            detail::runParallel(workers, [&](unsigned bucket) {
+                auto first = scattered.begin() + static_cast<std::ptrdiff_t>(bucket_begin[bucket]);
+                auto last = scattered.begin() + static_cast<std::ptrdiff_t>(bucket_begin[bucket + 1]);
+                std::sort(first, last, less);
+                std::copy(first, last, values.begin() + static_cast<std::ptrdiff_t>(bucket_begin[bucket]));
+            });
+        }
+
+        std::vector<KeyedFraction> withKeys(std::span<const Fraction> values) {
+            std::vector<KeyedFraction> keyed(values.size());
+            for (std::size_t i = 0; i < values.size(); i++) {
+                keyed[i] = {static_cast<double>(values[i].getNumerator()) / values[i].getDenominator(), values[i]};
+            }
+            return keyed;
+        }
+
+        void copyValues(const std::vector<KeyedFraction> &keyed, std::span<Fraction> values) {
+            for (std::size_t i = 0; i < values.size(); i++) {
+                values[i] = keyed[i].value;
+            }
+        }
+    }
+
+    void sort(std::span<Fraction> values, SortOptions options) {
+        unsigned workers = detail::workerCount(options.threads, MAX_WORKERS);
+        if (!options.precompute_keys) {
+            sampleSort(values, workers, ExactLess());
+            return;
+        }
+        std::vector<KeyedFraction> keyed = withKeys(values);
+        sampleSort(std::span<KeyedFraction>(keyed), workers, KeyedLess());
+        copyValues(keyed, values);
+    }
+
+    void nth_element(std::span<Fraction> values, std::size_t n) {
+        if (n < values.size()) {
+            std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(n), values.end(),
+                             ExactLess());
+        }
+    }
+
+    void partial_sort(std::span<Fraction> values, std::size_t middle) {
+        auto sorted = static_cast<std::ptrdiff_t>(std::min(middle, values.size()));
+        std::partial_sort(values.begin(), values.begin() + sorted, values.end(), ExactLess());
+    }
+}
@@ -0,0 +1,40 @@
+//
+// Sorting and selection of int fraction arrays with exact comparison.
+//
+
+#ifndef FRACTION_B_FRACTIONSORT_HPP
+#define FRACTION_B_FRACTIONSORT_HPP
+
+#include <cstddef>
+#include <span>
+
+#include "Fraction.hpp"
+
+namespace ariel {
+    // How sort orders fractions
+    struct SortOptions {
+        // Worker threads for large inputs, 0 for one per hardware thread
+        unsigned threads = 0;
+
+        // Compare precomputed double keys first and fall back to the exact comparison only when two keys
+        // are equal. Division rounds monotonically, so the order is still exact; it costs 16 bytes of
+        // extra memory per element.
+        bool precompute_keys = false;
+    };
+
+    // Sorts the fractions in ascending order. Inputs above about 64K elements are sample sorted in parallel:
+    // a sorted sample picks one splitter per thread, every element is moved to its bucket and the buckets
+    // are sorted concurrently.
+    void sort(std::span<Fraction> values, SortOptions options = {});
+
+    // Rearranges the fractions so that the one at index n is the one a full sort would put there, with no
+    // larger element before it and no smaller one after it. Does nothing if n is out of range.
+    // Selection compares each element only a few times, so precomputed keys would not pay for themselves.
+    void nth_element(std::span<Fraction> values, std::size_t n);
+
+    // Sorts the middle smallest fractions into [0, middle), the rest is left in unspecified order (top-k).
+    // middle is clamped to the size.
+    void partial_sort(std::span<Fraction> values, std::size_t middle);
+}
+
+#endif //FRACTION_B_FRACTIONSORT_HPP
@@ -0,0 +1,165 @@
+//
+// Optional counters of fraction operations, gcd work and result sizes.
+//
+#include "FractionStats.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace ariel {
+
+    namespace {
+        // The live threads, the totals of the threads that have exited and the totals at the last reset.
+        // Only registration, exit, snapshots and resets take the lock, never the counting itself.
+        struct Registry {
+            std::mutex mutex;
+            std::vector<detail::ThreadStats *> threads;
+            StatsSnapshot exited;
+            StatsSnapshot baseline;
+        };
+
+        // Constructed on first use, so that threads counting during static initialization find it
+        Registry &registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        template<std::size_t Size>
+        void addCounts(std::array<std::uint64_t, Size> &totals,
+                       const std::array<std::atomic<std::uint64_t>, Size> &counts) {
+            for (std::size_t i = 0; i < Size; i++) {
+                totals[i] += counts[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        void addThread(StatsSnapshot &totals, const detail::ThreadStats &stats) {
+            addCounts(totals.counters, stats.counters);
+            addCounts(totals.numerator_bits, stats.numerator_bits);
+            addCounts(totals.denominator_bits, stats.denominator_bits);
+        }
+
+        template<std::size_t Size>
+        void subtract(std::array<std::uint64_t, Size> &totals, const std::array<std::uint64_t, Size> &baseline) {
+            for (std::size_t i = 0; i < Size; i++) {
+                totals[i] -= baseline[i];
+            }
+        }
+
+        // Every count since the program started, the registry must be locked
+        StatsSnapshot totals(const Registry &instance) {
+            StatsSnapshot result = instance.exited;
+            for (const detail::ThreadStats *stats: instance.threads) {
+                addThread(result, *stats);
+            }
+            return result;
+        }
+
+        // Names of the counters in the JSON export, in the order of StatCounter
+        const std::array<const char *, STAT_COUNTERS> COUNTER_NAMES = {
+                "constructions", "additions", "subtractions", "multiplications", "divisions", "comparisons",
+                "increments", "decrements", "simplifications", "overflow_errors", "gcd_calls", "gcd_iterations"
+        };
+
+        // The operator label of the counters exported as fraction_operations_total, in the order of StatCounter
+        const std::array<const char *, static_cast<std::size_t>(StatCounter::Simplifications) + 1> OPERATOR_LABELS = {
+                "construct", "add", "subtract", "multiply", "divide", "compare", "increment", "decrement", "simplify"
+        };
+
+        void writeJsonArray(std::ostream &out, const std::array<std::uint64_t, TERM_BIT_BUCKETS> &counts) {
+            out << '[';
+            for (std::size_t i = 0; i < counts.size(); i++) {
+                out << (i == 0 ? "" : ",") << counts[i];
+            }
+            out << ']';
+        }
+
+        void writePrometheusCounter(std::ostream &out, const char *name, const char *help, std::uint64_t value) {
+            out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " counter\n" << name << ' ' << value
+                << '\n';
+        }
+
+        // A histogram of bit lengths, bucket le="k" counts the terms of at most k bits
+        void writePrometheusHistogram(std::ostream &out, const char *name, const char *help,
+                                      const std::array<std::uint64_t, TERM_BIT_BUCKETS> &counts) {
+            out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " histogram\n";
+            std::uint64_t cumulative = 0;
+            std::uint64_t bits = 0;
+            for (std::size_t i = 0; i < counts.size(); i++) {
+                cumulative += counts[i];
+                bits += counts[i] * i;
+                out << name << "_bucket{le=\"" << i << "\"} " << cumulative << '\n';
+            }
+            out << name << "_bucket{le=\"+Inf\"} " << cumulative << '\n' << name << "_sum " << bits << '\n' << name
+                << "_count " << cumulative << '\n';
+        }
+    }
+
+    namespace detail {
+        ThreadStats::ThreadStats() {
+            Registry &instance = registry();
+            std::lock_guard<std::mutex> lock(instance.mutex);
+            instance.threads.push_back(this);
+        }
+
+        ThreadStats::~ThreadStats() {
+            Registry &instance = registry();
+            std::lock_guard<std::mutex> lock(instance.mutex);
+            addThread(instance.exited, *this);
+            instance.threads.erase(std::find(instance.threads.begin(), instance.threads.end(), this));
+        }
+    }
+
+    // The totals minus the totals at the last reset, so resetting never races with a counting thread
+    StatsSnapshot stats_snapshot() {
+        Registry &instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        StatsSnapshot result = totals(instance);
+        subtract(result.counters, instance.baseline.counters);
+        subtract(result.numerator_bits, instance.baseline.numerator_bits);
+        subtract(result.denominator_bits, instance.baseline.denominator_bits);
+        return result;
+    }
+
+    void reset_stats() {
+        Registry &instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        instance.baseline = totals(instance);
+    }
+
+    std::string to_json(const StatsSnapshot &snapshot) {
+        std::ostringstream out;
+        out << "{\"enabled\":" << (STATS_ENABLED ? "true" : "false") << ",\"counters\":{";
+        for (std::size_t i = 0; i < STAT_COUNTERS; i++) {
+            out << (i == 0 ? "" : ",") << '"' << COUNTER_NAMES[i] << "\":" << snapshot.counters[i];
+        }
+        out << "},\"numerator_bits\":";
+        writeJsonArray(out, snapshot.numerator_bits);
+        out << ",\"denominator_bits\":";
+        writeJsonArray(out, snapshot.denominator_bits);
+        out << '}';
+        return out.str();
+    }
+
+    std::string to_prometheus(const StatsSnapshot &snapshot) {
+        std::ostringstream out;
+        out << "# HELP fraction_operations_total Fraction operations by operator.\n"
+               "# TYPE fraction_operations_total counter\n";
+        for (std::size_t i = 0; i < OPERATOR_LABELS.size(); i++) {
+            out << "fraction_operations_total{operator=\"" << OPERATOR_LABELS[i] << "\"} " << snapshot.counters[i]
+                << '\n';
+        }
+        writePrometheusCounter(out, "fraction_overflow_errors_total", "Results that did not fit and threw.",
+                               snapshot[StatCounter::OverflowErrors]);
+        writePrometheusCounter(out, "fraction_gcd_calls_total", "Gcd computations of the fraction types.",
+                               snapshot[StatCounter::GcdCalls]);
+        writePrometheusCounter(out, "fraction_gcd_iterations_total", "Loop iterations of the gcd kernels.",
+                               snapshot[StatCounter::GcdIterations]);
+        writePrometheusHistogram(out, "fraction_numerator_bits", "Bit length of result numerators.",
+                                 snapshot.numerator_bits);
+        writePrometheusHistogram(out, "fraction_denominator_bits", "Bit length of result denominators.",
+                                 snapshot.denominator_bits);
+        return out.str();
+    }
+}
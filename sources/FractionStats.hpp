@@ -0,0 +1,113 @@
+//
+// Optional counters of fraction operations, gcd work and result sizes.
+//
+
+#ifndef FRACTION_B_FRACTIONSTATS_HPP
+#define FRACTION_B_FRACTIONSTATS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace ariel {
+    // Defining FRACTION_STATS (make STATS=1) turns the counters on. Without it the hooks in the operators
+    // are empty and the snapshot is always zero.
+#ifdef FRACTION_STATS
+    inline constexpr bool STATS_ENABLED = true;
+#else
+    inline constexpr bool STATS_ENABLED = false;
+#endif
+
+    // The counted events
+    enum class StatCounter {
+        Constructions,   // Fractions made from a numerator and denominator or from a float
+        Additions,
+        Subtractions,
+        Multiplications,
+        Divisions,
+        Comparisons,     // operator<=> and operator==, which the other comparisons go through
+        Increments,
+        Decrements,
+        Simplifications,
+        OverflowErrors,  // overflow_error thrown for a result that does not fit
+        GcdCalls,        // gcd computations of the fraction types
+        GcdIterations    // Loop iterations of the gcd kernels, including direct calls by sums and parsing
+    };
+
+    const std::size_t STAT_COUNTERS = static_cast<std::size_t>(StatCounter::GcdIterations) + 1;
+
+    // Histogram buckets of term sizes, bucket k counts terms whose magnitude has k bits
+    const std::size_t TERM_BIT_BUCKETS = 129;
+
+    // Totals of all threads since the last reset_stats(). The histograms count the terms of every fraction
+    // constructed or returned by an arithmetic operator.
+    struct StatsSnapshot {
+        std::array<std::uint64_t, STAT_COUNTERS> counters{};
+        std::array<std::uint64_t, TERM_BIT_BUCKETS> numerator_bits{};
+        std::array<std::uint64_t, TERM_BIT_BUCKETS> denominator_bits{};
+
+        std::uint64_t operator[](StatCounter counter) const { return counters[static_cast<std::size_t>(counter)]; }
+    };
+
+    // Adds up the counters of all threads, including threads that have exited
+    StatsSnapshot stats_snapshot();
+
+    // Starts counting from zero again, the counters of running threads are not touched
+    void reset_stats();
+
+    // The snapshot as a JSON object: "enabled", "counters" by name and the two histograms as arrays
+    std::string to_json(const StatsSnapshot& snapshot);
+
+    // The snapshot in the Prometheus text exposition format, the histograms with cumulative buckets
+    std::string to_prometheus(const StatsSnapshot& snapshot);
+
+    namespace detail {
+        // The counters of one thread. Only the owning thread writes them, with a plain load and store
+        // rather than a locked read-modify-write; the atomics only make the reads of stats_snapshot() safe.
+        // Threads register themselves on first use and fold their counts into a global total on exit.
+        struct ThreadStats {
+            std::array<std::atomic<std::uint64_t>, STAT_COUNTERS> counters{};
+            std::array<std::atomic<std::uint64_t>, TERM_BIT_BUCKETS> numerator_bits{};
+            std::array<std::atomic<std::uint64_t>, TERM_BIT_BUCKETS> denominator_bits{};
+
+            ThreadStats();
+
+            ~ThreadStats();
+
+            ThreadStats(const ThreadStats&) = delete;
+
+            ThreadStats& operator=(const ThreadStats&) = delete;
+
+            static void add(std::atomic<std::uint64_t>& counter, std::uint64_t count) {
+                counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+            }
+        };
+
+#ifdef FRACTION_STATS
+        inline thread_local ThreadStats thread_stats;
+#endif
+
+        // Hooks called by the fraction code, they do nothing when the counters are off or in constant evaluation
+        constexpr void countStat([[maybe_unused]] StatCounter counter, [[maybe_unused]] std::uint64_t count = 1) {
+#ifdef FRACTION_STATS
+            if (!std::is_constant_evaluated()) {
+                ThreadStats::add(thread_stats.counters[static_cast<std::size_t>(counter)], count);
+            }
+#endif
+        }
+
+        constexpr void countTermBits([[maybe_unused]] int numerator_bits, [[maybe_unused]] int denominator_bits) {
+#ifdef FRACTION_STATS
+            if (!std::is_constant_evaluated()) {
+                ThreadStats::add(thread_stats.numerator_bits[static_cast<std::size_t>(numerator_bits)], 1);
+                ThreadStats::add(thread_stats.denominator_bits[static_cast<std::size_t>(denominator_bits)], 1);
+            }
+#endif
+        }
+    }
+}
+
+#endif //FRACTION_B_FRACTIONSTATS_HPP
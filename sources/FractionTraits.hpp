@@ -0,0 +1,129 @@
+//
+// Width traits describing how BasicFraction stores and checks each integer type.
+//
+
+#ifndef FRACTION_B_FRACTIONTRAITS_HPP
+#define FRACTION_B_FRACTIONTRAITS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "Gcd.hpp"
+
+namespace ariel {
+
+    namespace detail {
+        // The next wider signed type for each width, used for exact intermediate results
+        template<std::size_t Size>
+        struct WiderInt;
+
+        // 8 and 16 bit values are promoted to int by the language anyway, so they share the int path
+        template<>
+        struct WiderInt<1> {
+            using type = std::int32_t;
+        };
+
+        template<>
+        struct WiderInt<2> {
+            using type = std::int32_t;
+        };
+
+        template<>
+        struct WiderInt<4> {
+            using type = std::int64_t;
+        };
+
+        template<>
+        struct WiderInt<8> {
+            using type = int128_t;
+        };
+
+        // The unsigned type of each width, std::make_unsigned does not accept 128-bit values in strict mode
+        template<std::size_t Size>
+        struct UnsignedInt;
+
+        template<>
+        struct UnsignedInt<4> {
+            using type = std::uint32_t;
+        };
+
+        template<>
+        struct UnsignedInt<8> {
+            using type = std::uint64_t;
+        };
+
+        template<>
+        struct UnsignedInt<16> {
+            using type = uint128_t;
+        };
+
+        // Absolute value of a 128-bit value as an unsigned value, well defined for the minimum value too
+        constexpr uint128_t magnitude128(int128_t value) {
+            return value < 0 ? uint128_t{0} - static_cast<uint128_t>(value) : static_cast<uint128_t>(value);
+        }
+    }
+
+    // Describes how a BasicFraction stores and checks values of a given signed integer width.
+    // Widths up to 64 bits compute sums and products exactly in the next wider type and only
+    // range-check the reduced result. The 128-bit specialization has no wider type and relies on
+    // the checked __builtin_*_overflow operations instead.
+    template<typename IntT>
+    struct FractionTraits {
+        static_assert(std::numeric_limits<IntT>::is_integer && std::numeric_limits<IntT>::is_signed,
+                      "BasicFraction requires a signed integer type");
+
+        using int_type = IntT;
+        using wide_type = typename detail::WiderInt<sizeof(IntT)>::type;
+        using unsigned_wide_type = typename detail::UnsignedInt<sizeof(wide_type)>::type;
+
+        static constexpr bool has_wide_type = true;
+
+        static constexpr IntT min() { return std::numeric_limits<IntT>::min(); }
+
+        static constexpr IntT max() { return std::numeric_limits<IntT>::max(); }
+
+        // Returns true if a wide intermediate value can be stored back in IntT
+        static constexpr bool fits(wide_type value) { return value >= min() && value <= max(); }
+
+        // Greatest common divisor, always non negative. Called with IntT values by simplify() and with
+        // wide intermediate values by the arithmetic operators. Values up to 64 bits use the binary gcd,
+        // the 128-bit intermediates of 64-bit fractions use Lehmer's algorithm.
+        template<typename T>
+        static constexpr T gcd(T lhs, T rhs) {
+            detail::countStat(StatCounter::GcdCalls);
+            if constexpr (sizeof(T) > sizeof(std::uint64_t)) {
+                return static_cast<T>(lehmerGcd(detail::magnitude128(lhs), detail::magnitude128(rhs)));
+            } else {
+                using UnsignedT = std::conditional_t<(sizeof(T) > sizeof(std::uint32_t)), std::uint64_t, std::uint32_t>;
+                return static_cast<T>(binaryGcd<UnsignedT>(static_cast<UnsignedT>(detail::magnitude128(lhs)),
+                                                           static_cast<UnsignedT>(detail::magnitude128(rhs))));
+            }
+        }
+    };
+
+    template<>
+    struct FractionTraits<int128_t> {
+        using int_type = int128_t;
+        using wide_type = int128_t;
+        using unsigned_wide_type = uint128_t;
+
+        static constexpr bool has_wide_type = false;
+
+        static constexpr int128_t max() { return static_cast<int128_t>(~uint128_t{0} >> 1U); }
+
+        static constexpr int128_t min() { return -max() - 1; }
+
+        static constexpr bool fits(int128_t /*value*/) { return true; }
+
+        // The result does not fit in 128 bits only for gcd(min, 0) and gcd(min, min)
+        template<typename T>
+        static constexpr int128_t gcd(T lhs, T rhs) {
+            detail::countStat(StatCounter::GcdCalls);
+            return static_cast<int128_t>(lehmerGcd(detail::magnitude128(lhs), detail::magnitude128(rhs)));
+        }
+    };
+}
+
+#endif //FRACTION_B_FRACTIONTRAITS_HPP
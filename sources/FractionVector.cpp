@@ -0,0 +1,576 @@
+//
+// Structure of arrays container for int fractions with vectorized batch arithmetic.
+//
+#include "FractionVector.hpp"
+
+#include <cstdint>
+#include <immintrin.h>
+#include <limits>
+#include <stdexcept>
+
+#include "Gcd.hpp"
+
+// Functions compiled for an instruction set the rest of the build does not assume
+#define FRACTION_AVX2 __attribute__((target("avx2")))
+#define FRACTION_SSE4 __attribute__((target("sse4.2")))
+
+namespace ariel {
+
+    namespace {
+        using Wide = std::int64_t;
+
+        const Wide INT_MAXIMUM = std::numeric_limits<int>::max();
+        const Wide INT_MINIMUM = std::numeric_limits<int>::min();
+
+        std::uint64_t magnitude(Wide value) {
+            return value < 0 ? std::uint64_t{0} - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+        }
+
+        // Stores a reduced result with a positive denominator, throws overflow_error like Fraction if it does not fit
+        void store(Wide numerator, Wide denominator, int *numerators, int *denominators, std::size_t index) {
+            if (numerator < INT_MINIMUM || numerator > INT_MAXIMUM || denominator > INT_MAXIMUM) {
+                throw std::overflow_error("Fraction overflow");
+            }
+            numerators[index] = static_cast<int>(numerator);
+            denominators[index] = static_cast<int>(denominator);
+        }
+
+        // Stores a sum formed as in BasicFraction::addChecked: a/b + c/d = (a*(d/g) + c*(b/g)) / (b/g * d)
+        // with g = gcd(b, d). The sum and its denominator can only share factors of g.
+        void storeSum(Wide sum, Wide denominator, std::uint32_t gcd, int *numerators, int *denominators,
+                      std::size_t index) {
+            if (sum == 0) {
+                numerators[index] = 0;
+                denominators[index] = 1;
+                return;
+            }
+            if (gcd != 1) {
+                auto common = static_cast<Wide>(binaryGcd<std::uint32_t>(static_cast<std::uint32_t>(magnitude(sum) % gcd),
+                                                                         gcd));
+                sum /= common;
+                denominator /= common;
+            }
+            store(sum, denominator, numerators, denominators, index);
+        }
+
+        // Scalar kernels, also used for the elements left over by the vector kernels.
+        // The lhs fractions are a/b and the rhs fractions c/d, results go to n/r.
+
+        void addScalar(const int *a, const int *b, const int *c, const int *d, int *n, int *r,
+                       std::size_t begin, std::size_t end, bool subtract) {
+            for (std::size_t i = begin; i < end; i++) {
+                auto gcd = binaryGcd<std::uint32_t>(static_cast<std::uint32_t>(b[i]), static_cast<std::uint32_t>(d[i]));
+                Wide lhs_scale = d[i] / static_cast<Wide>(gcd);
+                Wide rhs_scale = b[i] / static_cast<Wide>(gcd);
+                Wide lhs_term = a[i] * lhs_scale;
+                Wide rhs_term = c[i] * rhs_scale;
+                storeSum(subtract ? lhs_term - rhs_term : lhs_term + rhs_term, rhs_scale * d[i], gcd, n, r, i);
+            }
+        }
+
+        void multiplyScalar(const int *a, const int *b, const int *c, const int *d, int *n, int *r,
+                            std::size_t begin, std::size_t end, bool divide) {
+            for (std::size_t i = begin; i < end; i++) {
+                Wide rhs_numerator = c[i];
+                Wide rhs_denominator = d[i];
+                if (divide) {
+                    if (c[i] == 0) {
+                        throw std::runtime_error("Division by zero");
+                    }
+                    // Multiply by the reciprocal, keeping its denominator positive
+                    rhs_numerator = c[i] < 0 ? -rhs_denominator : rhs_denominator;
+                    rhs_denominator = c[i] < 0 ? -static_cast<Wide>(c[i]) : c[i];
+                }
+                if (a[i] == 0 || rhs_numerator == 0) {
+                    n[i] = 0;
+                    r[i] = 1;
+                    continue;
+                }
+                // Cross-cancellation as in BasicFraction::multiplyReduced
+                auto lhs_gcd = static_cast<Wide>(binaryGcd<std::uint64_t>(magnitude(a[i]),
+                                                                          static_cast<std::uint64_t>(rhs_denominator)));
+                auto rhs_gcd = static_cast<Wide>(binaryGcd<std::uint64_t>(magnitude(rhs_numerator),
+                                                                          static_cast<std::uint64_t>(b[i])));
+                store((a[i] / lhs_gcd) * (rhs_numerator / rhs_gcd), (b[i] / rhs_gcd) * (rhs_denominator / lhs_gcd),
+                      n, r, i);
+            }
+        }
+
+        void compareScalar(const int *a, const int *b, const int *c, const int *d, int *result,
+                           std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                Wide lhs = static_cast<Wide>(a[i]) * d[i];
+                Wide rhs = static_cast<Wide>(c[i]) * b[i];
+                result[i] = (lhs > rhs ? 1 : 0) - (lhs < rhs ? 1 : 0);
+            }
+        }
+
+        void reduceScalar(int *n, int *r, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                if (r[i] == 0) {
+                    throw std::invalid_argument("Division by zero");
+                }
+                auto gcd = static_cast<Wide>(binaryGcd<std::uint64_t>(magnitude(n[i]), magnitude(r[i])));
+                Wide numerator = n[i] / gcd;
+                Wide denominator = r[i] / gcd;
+                if (denominator < 0) {
+                    numerator = -numerator;
+                    denominator = -denominator;
+                }
+                store(numerator, denominator, n, r, i);
+            }
+        }
+
+        // AVX2 kernels, 8 elements per step.
+        // Lanes holding INT_MIN (whose magnitude does not fit in a signed lane) or a zero divisor are rare
+        // and their whole step is handed to the scalar kernel, which also throws the right exception.
+
+        // 64-bit results of a lane wise 32-bit operation: lanes 0, 2, 4, 6 in even and 1, 3, 5, 7 in odd
+        struct WideAvx2 {
+            __m256i even;
+            __m256i odd;
+        };
+
+        // Counts trailing zeros of each 32-bit lane below 2^31: the lowest set bit is isolated and its
+        // position read from the exponent of its float conversion. Zero lanes give a count above 31,
+        // which shifts them to zero again.
+        FRACTION_AVX2 __m256i trailingZerosAvx2(__m256i value) {
+            const int mantissa_bits = 23;
+            const int exponent_mask = 0xff;
+            const int exponent_bias = 127;
+            __m256i lowest = _mm256_and_si256(value, _mm256_sub_epi32(_mm256_setzero_si256(), value));
+            __m256i bits = _mm256_castps_si256(_mm256_cvtepi32_ps(lowest));
+            __m256i exponent = _mm256_and_si256(_mm256_srli_epi32(bits, mantissa_bits), _mm256_set1_epi32(exponent_mask));
+            return _mm256_sub_epi32(exponent, _mm256_set1_epi32(exponent_bias));
+        }
+
+        // Binary gcd of each pair of lanes below 2^31, every lane runs until the slowest one is done
+        FRACTION_AVX2 __m256i gcdAvx2(__m256i lhs, __m256i rhs) {
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i lhs_zero = _mm256_cmpeq_epi32(lhs, zero);
+            __m256i rhs_zero = _mm256_cmpeq_epi32(rhs, zero);
+            __m256i shift = trailingZerosAvx2(_mm256_or_si256(lhs, rhs));
+            __m256i odd = _mm256_srlv_epi32(lhs, trailingZerosAvx2(lhs));
+            // Lanes with a zero input take no steps, gcd(x, 0) = x is blended in at the end
+            __m256i rest = _mm256_andnot_si256(_mm256_or_si256(lhs_zero, rhs_zero), rhs);
+            while (_mm256_testz_si256(rest, rest) == 0) {
+                __m256i done = _mm256_cmpeq_epi32(rest, zero);
+                rest = _mm256_srlv_epi32(rest, trailingZerosAvx2(rest));
+                __m256i smaller = _mm256_min_epu32(odd, rest);
+                __m256i larger = _mm256_max_epu32(odd, rest);
+                odd = _mm256_blendv_epi8(smaller, odd, done);
+                rest = _mm256_andnot_si256(done, _mm256_sub_epi32(larger, smaller));
+            }
+            __m256i result = _mm256_sllv_epi32(odd, shift);
+            result = _mm256_blendv_epi8(result, rhs, lhs_zero);
+            return _mm256_blendv_epi8(result, lhs, rhs_zero);
+        }
+
+        // Divides lanes by positive divisors that divide them exactly, doubles hold both exactly
+        FRACTION_AVX2 __m256i divideExactAvx2(__m256i value, __m256i divisor) {
+            __m128i low = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(value)),
+                                                            _mm256_cvtepi32_pd(_mm256_castsi256_si128(divisor))));
+            __m128i high = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(value, 1)),
+                                                             _mm256_cvtepi32_pd(_mm256_extracti128_si256(divisor, 1))));
+            return _mm256_set_m128i(high, low);
+        }
+
+        FRACTION_AVX2 WideAvx2 multiplyWideAvx2(__m256i lhs, __m256i rhs) {
+            const int half = 32;
+            return {_mm256_mul_epi32(lhs, rhs),
+                    _mm256_mul_epi32(_mm256_srli_epi64(lhs, half), _mm256_srli_epi64(rhs, half))};
+        }
+
+        // Mask of the 64-bit lanes outside the int range
+        FRACTION_AVX2 __m256i outOfRangeAvx2(WideAvx2 value) {
+            const __m256i maximum = _mm256_set1_epi64x(INT_MAXIMUM);
+            const __m256i minimum = _mm256_set1_epi64x(INT_MINIMUM);
+            return _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi64(value.even, maximum),
+                                                   _mm256_cmpgt_epi64(minimum, value.even)),
+                                   _mm256_or_si256(_mm256_cmpgt_epi64(value.odd, maximum),
+                                                   _mm256_cmpgt_epi64(minimum, value.odd)));
+        }
+
+        // Packs 64-bit lanes known to fit back into 32-bit lanes in their original order
+        FRACTION_AVX2 __m256i narrowAvx2(WideAvx2 value) {
+            const int half = 32;
+            const int odd_lanes = 0xaa;
+            return _mm256_blend_epi32(value.even, _mm256_slli_epi64(value.odd, half), odd_lanes);
+        }
+
+        FRACTION_AVX2 __m256i loadAvx2(const int *source) {
+            return _mm256_load_si256(reinterpret_cast<const __m256i *>(source));
+        }
+
+        FRACTION_AVX2 void storeAvx2(int *destination, __m256i value) {
+            _mm256_store_si256(reinterpret_cast<__m256i *>(destination), value);
+        }
+
+        FRACTION_AVX2 void addAvx2(const int *a, const int *b, const int *c, const int *d, int *n, int *r,
+                                   std::size_t count, bool subtract) {
+            const std::size_t lanes = 8;
+            const __m256i one = _mm256_set1_epi32(1);
+            std::size_t i = 0;
+            for (; i + lanes <= count; i += lanes) {
+                __m256i lhs_denominator = loadAvx2(b + i);
+                __m256i rhs_denominator = loadAvx2(d + i);
+                __m256i gcd = gcdAvx2(lhs_denominator, rhs_denominator);
+                __m256i lhs_scale = divideExactAvx2(rhs_denominator, gcd);
+                __m256i rhs_scale = divideExactAvx2(lhs_denominator, gcd);
+                WideAvx2 lhs_term = multiplyWideAvx2(loadAvx2(a + i), lhs_scale);
+                WideAvx2 rhs_term = multiplyWideAvx2(loadAvx2(c + i), rhs_scale);
+                WideAvx2 sum = subtract
+                               ? WideAvx2{_mm256_sub_epi64(lhs_term.even, rhs_term.even),
+                                          _mm256_sub_epi64(lhs_term.odd, rhs_term.odd)}
+                               : WideAvx2{_mm256_add_epi64(lhs_term.even, rhs_term.even),
+                                          _mm256_add_epi64(lhs_term.odd, rhs_term.odd)};
+                WideAvx2 denominator = multiplyWideAvx2(rhs_scale, rhs_denominator);
+                // With coprime denominators the sum is already reduced
+                __m256i slow = _mm256_or_si256(_mm256_xor_si256(_mm256_cmpeq_epi32(gcd, one), _mm256_set1_epi32(-1)),
+                                               _mm256_or_si256(outOfRangeAvx2(sum), outOfRangeAvx2(denominator)));
+                if (_mm256_testz_si256(slow, slow) != 0) {
+                    storeAvx2(n + i, narrowAvx2(sum));
+                    storeAvx2(r + i, narrowAvx2(denominator));
+                    continue;
+                }
+                alignas(FractionVector::ALIGNMENT) Wide sums[2][lanes / 2];
+                alignas(FractionVector::ALIGNMENT) Wide denominators[2][lanes / 2];
+                alignas(FractionVector::ALIGNMENT) std::uint32_t gcds[lanes];
+                _mm256_store_si256(reinterpret_cast<__m256i *>(sums[0]), sum.even);
+                _mm256_store_si256(reinterpret_cast<__m256i *>(sums[1]), sum.odd);
+                _mm256_store_si256(reinterpret_cast<__m256i *>(denominators[0]), denominator.even);
+                _mm256_store_si256(reinterpret_cast<__m256i *>(denominators[1]), denominator.odd);
+                _mm256_store_si256(reinterpret_cast<__m256i *>(gcds), gcd);
+                for (std::size_t lane = 0; lane < lanes; lane++) {
+                    storeSum(sums[lane % 2][lane / 2], denominators[lane % 2][lane / 2], gcds[lane], n, r, i + lane);
+                }
+            }
+            addScalar(a, b, c, d, n, r, i, count, subtract);
+        }
+
+        FRACTION_AVX2 void multiplyAvx2(const int *a, const int *b, const int *c, const int *d, int *n, int *r,
+                                        std::size_t count, bool divide) {
+            const std::size_t lanes = 8;
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i one = _mm256_set1_epi32(1);
+            const __m256i minimum = _mm256_set1_epi32(static_cast<int>(INT_MINIMUM));
+            std::size_t i = 0;
+            for (; i + lanes <= count; i += lanes) {
+                __m256i lhs_numerator = loadAvx2(a + i);
+                __m256i lhs_denominator = loadAvx2(b + i);
+                __m256i rhs_numerator = loadAvx2(c + i);
+                __m256i rhs_denominator = loadAvx2(d + i);
+                __m256i special = _mm256_or_si256(_mm256_cmpeq_epi32(lhs_numerator, minimum),
+                                                  _mm256_cmpeq_epi32(rhs_numerator, minimum));
+                if (divide) {
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi32(rhs_numerator, zero));
+                    // Multiply by the reciprocal, keeping its denominator positive
+                    __m256i reciprocal_numerator = _mm256_sign_epi32(rhs_denominator, rhs_numerator);
+                    rhs_denominator = _mm256_abs_epi32(rhs_numerator);
+                    rhs_numerator = reciprocal_numerator;
+                }
+                if (_mm256_testz_si256(special, special) == 0) {
+                    multiplyScalar(a, b, c, d, n, r, i, i + lanes, divide);
+                    continue;
+                }
+                // Cross-cancellation as in BasicFraction::multiplyReduced
+                __m256i lhs_gcd = gcdAvx2(_mm256_abs_epi32(lhs_numerator), rhs_denominator);
+                __m256i rhs_gcd = gcdAvx2(_mm256_abs_epi32(rhs_numerator), lhs_denominator);
+                WideAvx2 numerator = multiplyWideAvx2(divideExactAvx2(lhs_numerator, lhs_gcd),
+                                                      divideExactAvx2(rhs_numerator, rhs_gcd));
+                WideAvx2 denominator = multiplyWideAvx2(divideExactAvx2(lhs_denominator, rhs_gcd),
+                                                        divideExactAvx2(rhs_denominator, lhs_gcd));
+                __m256i overflow = _mm256_or_si256(outOfRangeAvx2(numerator), outOfRangeAvx2(denominator));
+                if (_mm256_testz_si256(overflow, overflow) == 0) {
+                    throw std::overflow_error("Fraction overflow");
+                }
+                __m256i result_numerator = narrowAvx2(numerator);
+                // A zero product has the denominator 1
+                __m256i result_denominator = _mm256_blendv_epi8(narrowAvx2(denominator), one,
+                                                                _mm256_cmpeq_epi32(result_numerator, zero));
+                storeAvx2(n + i, result_numerator);
+                storeAvx2(r + i, result_denominator);
+            }
+            multiplyScalar(a, b, c, d, n, r, i, count, divide);
+        }
+
+        FRACTION_AVX2 void compareAvx2(const int *a, const int *b, const int *c, const int *d, int *result,
+                                       std::size_t count) {
+            const std::size_t lanes = 8;
+            std::size_t i = 0;
+            for (; i + lanes <= count; i += lanes) {
+                WideAvx2 lhs = multiplyWideAvx2(loadAvx2(a + i), loadAvx2(d + i));
+                WideAvx2 rhs = multiplyWideAvx2(loadAvx2(c + i), loadAvx2(b + i));
+                // Comparison masks are -1, so less - greater gives -1, 0 or 1
+                WideAvx2 sign{_mm256_sub_epi64(_mm256_cmpgt_epi64(rhs.even, lhs.even), _mm256_cmpgt_epi64(lhs.even, rhs.even)),
+                              _mm256_sub_epi64(_mm256_cmpgt_epi64(rhs.odd, lhs.odd), _mm256_cmpgt_epi64(lhs.odd, rhs.odd))};
+                storeAvx2(result + i, narrowAvx2(sign));
+            }
+            compareScalar(a, b, c, d, result, i, count);
+        }
+
+        FRACTION_AVX2 void reduceAvx2(int *n, int *r, std::size_t count) {
+            const std::size_t lanes = 8;
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i minimum = _mm256_set1_epi32(static_cast<int>(INT_MINIMUM));
+            std::size_t i = 0;
+            for (; i + lanes <= count; i += lanes) {
+                __m256i numerator = loadAvx2(n + i);
+                __m256i denominator = loadAvx2(r + i);
+                __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi32(numerator, minimum),
+                                                                  _mm256_cmpeq_epi32(denominator, minimum)),
+                                                  _mm256_cmpeq_epi32(denominator, zero));
+                if (_mm256_testz_si256(special, special) == 0) {
+                    reduceScalar(n, r, i, i + lanes);
+                    continue;
+                }
+                __m256i gcd = gcdAvx2(_mm256_abs_epi32(numerator), _mm256_abs_epi32(denominator));
+                numerator = divideExactAvx2(numerator, gcd);
+                denominator = divideExactAvx2(denominator, gcd);
+                // Moves the sign of the denominator to the numerator
+                storeAvx2(n + i, _mm256_sign_epi32(numerator, denominator));
+                storeAvx2(r + i, _mm256_abs_epi32(denominator));
+            }
+            reduceScalar(n, r, i, count);
+        }
+
+        // SSE4 kernels, 4 elements per step. SSE4 has no per lane shifts for the binary gcd, so only the
+        // comparison is vectorized; running the gcds lane by lane made add and mul slower than the scalar kernels.
+
+        struct WideSse4 {
+            __m128i even;
+            __m128i odd;
+        };
+
+        FRACTION_SSE4 WideSse4 multiplyWideSse4(__m128i lhs, __m128i rhs) {
+            const int half = 32;
+            return {_mm_mul_epi32(lhs, rhs), _mm_mul_epi32(_mm_srli_epi64(lhs, half), _mm_srli_epi64(rhs, half))};
+        }
+
+        FRACTION_SSE4 __m128i narrowSse4(WideSse4 value) {
+            const int half = 32;
+            const int odd_lanes = 0xcc;
+            return _mm_blend_epi16(value.even, _mm_slli_epi64(value.odd, half), odd_lanes);
+        }
+
+        FRACTION_SSE4 __m128i loadSse4(const int *source) {
+            return _mm_load_si128(reinterpret_cast<const __m128i *>(source));
+        }
+
+        FRACTION_SSE4 void storeSse4(int *destination, __m128i value) {
+            _mm_store_si128(reinterpret_cast<__m128i *>(destination), value);
+        }
+
+        FRACTION_SSE4 void compareSse4(const int *a, const int *b, const int *c, const int *d, int *result,
+                                       std::size_t count) {
+            const std::size_t lanes = 4;
+            std::size_t i = 0;
+            for (; i + lanes <= count; i += lanes) {
+                WideSse4 lhs = multiplyWideSse4(loadSse4(a + i), loadSse4(d + i));
+                WideSse4 rhs = multiplyWideSse4(loadSse4(c + i), loadSse4(b + i));
+                WideSse4 sign{_mm_sub_epi64(_mm_cmpgt_epi64(rhs.even, lhs.even), _mm_cmpgt_epi64(lhs.even, rhs.even)),
+                              _mm_sub_epi64(_mm_cmpgt_epi64(rhs.odd, lhs.odd), _mm_cmpgt_epi64(lhs.odd, rhs.odd))};
+                storeSse4(result + i, narrowSse4(sign));
+            }
+            compareScalar(a, b, c, d, result, i, count);
+        }
+
+        // Runtime dispatch
+
+        void addFallback(const int *a, const int *b, const int *c, const int *d, int *n, int *r,
+                         std::size_t count, bool subtract) {
+            addScalar(a, b, c, d, n, r, 0, count, subtract);
+        }
+
+        void multiplyFallback(const int *a, const int *b, const int *c, const int *d, int *n, int *r,
+                              std::size_t count, bool divide) {
+            multiplyScalar(a, b, c, d, n, r, 0, count, divide);
+        }
+
+        void compareFallback(const int *a, const int *b, const int *c, const int *d, int *result, std::size_t count) {
+            compareScalar(a, b, c, d, result, 0, count);
+        }
+
+        void reduceFallback(int *n, int *r, std::size_t count) {
+            reduceScalar(n, r, 0, count);
+        }
+
+        // The kernels of one instruction set
+        struct Kernels {
+            void (*add)(const int *, const int *, const int *, const int *, int *, int *, std::size_t, bool);
+            void (*multiply)(const int *, const int *, const int *, const int *, int *, int *, std::size_t, bool);
+            void (*compare)(const int *, const int *, const int *, const int *, int *, std::size_t);
+            void (*reduce)(int *, int *, std::size_t);
+        };
+
+        const Kernels SCALAR_KERNELS{addFallback, multiplyFallback, compareFallback, reduceFallback};
+        const Kernels SSE4_KERNELS{addFallback, multiplyFallback, compareSse4, reduceFallback};
+        const Kernels AVX2_KERNELS{addAvx2, multiplyAvx2, compareAvx2, reduceAvx2};
+
+        FractionVector::SimdLevel detectSimdLevel() {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return FractionVector::SimdLevel::Avx2;
+            }
+            if (__builtin_cpu_supports("sse4.2")) {
+                return FractionVector::SimdLevel::Sse4;
+            }
+            return FractionVector::SimdLevel::Scalar;
+        }
+
+        // The selected instruction set, detected on first use
+        FractionVector::SimdLevel &currentSimdLevel() {
+            static FractionVector::SimdLevel level = FractionVector::supportedSimdLevel();
+            return level;
+        }
+
+        const Kernels &kernels() {
+            switch (currentSimdLevel()) {
+                case FractionVector::SimdLevel::Avx2:
+                    return AVX2_KERNELS;
+                case FractionVector::SimdLevel::Sse4:
+                    return SSE4_KERNELS;
+                default:
+                    return SCALAR_KERNELS;
+            }
+        }
+    }
+
+    FractionVector::FractionVector() = default;
+
+    FractionVector::FractionVector(std::size_t size) : numerator_values(size, 0), denominator_values(size, 1) {}
+
+    FractionVector::FractionVector(std::initializer_list<Fraction> fractions) {
+        reserve(fractions.size());
+        for (const Fraction &fraction: fractions) {
+            push_back(fraction);
+        }
+    }
+
+    FractionVector::FractionVector(const std::vector<Fraction> &fractions) {
+        reserve(fractions.size());
+        for (const Fraction &fraction: fractions) {
+            push_back(fraction);
+        }
+    }
+
+    std::size_t FractionVector::size() const {
+        return numerator_values.size();
+    }
+
+    bool FractionVector::empty() const {
+        return numerator_values.empty();
+    }
+
+    void FractionVector::reserve(std::size_t capacity) {
+        numerator_values.reserve(capacity);
+        denominator_values.reserve(capacity);
+    }
+
+    void FractionVector::clear() {
+        numerator_values.clear();
+        denominator_values.clear();
+    }
+
+    void FractionVector::resize(std::size_t size) {
+        numerator_values.resize(size, 0);
+        denominator_values.resize(size, 1);
+    }
+
+    void FractionVector::push_back(const Fraction &fraction) {
+        numerator_values.push_back(fraction.getNumerator());
+        denominator_values.push_back(fraction.getDenominator());
+    }
+
+    Fraction FractionVector::operator[](std::size_t index) const {
+        return Fraction(numerator_values[index], denominator_values[index]);
+    }
+
+    void FractionVector::set(std::size_t index, const Fraction &fraction) {
+        numerator_values[index] = fraction.getNumerator();
+        denominator_values[index] = fraction.getDenominator();
+    }
+
+    int *FractionVector::numerators() {
+        return numerator_values.data();
+    }
+
+    const int *FractionVector::numerators() const {
+        return numerator_values.data();
+    }
+
+    int *FractionVector::denominators() {
+        return denominator_values.data();
+    }
+
+    const int *FractionVector::denominators() const {
+        return denominator_values.data();
+    }
+
+    void FractionVector::checkSize(const FractionVector &other) const {
+        if (size() != other.size()) {
+            throw std::invalid_argument("FractionVector sizes differ");
+        }
+    }
+
+    void FractionVector::reduce() {
+        kernels().reduce(numerators(), denominators(), size());
+    }
+
+    FractionVector FractionVector::add(const FractionVector &other) const {
+        checkSize(other);
+        FractionVector result(size());
+        kernels().add(numerators(), denominators(), other.numerators(), other.denominators(),
+                      result.numerators(), result.denominators(), size(), false);
+        return result;
+    }
+
+    FractionVector FractionVector::sub(const FractionVector &other) const {
+        checkSize(other);
+        FractionVector result(size());
+        kernels().add(numerators(), denominators(), other.numerators(), other.denominators(),
+                      result.numerators(), result.denominators(), size(), true);
+        return result;
+    }
+
+    FractionVector FractionVector::mul(const FractionVector &other) const {
+        checkSize(other);
+        FractionVector result(size());
+        kernels().multiply(numerators(), denominators(), other.numerators(), other.denominators(),
+                           result.numerators(), result.denominators(), size(), false);
+        return result;
+    }
+
+    FractionVector FractionVector::div(const FractionVector &other) const {
+        checkSize(other);
+        FractionVector result(size());
+        kernels().multiply(numerators(), denominators(), other.numerators(), other.denominators(),
+                           result.numerators(), result.denominators(), size(), true);
+        return result;
+    }
+
+    std::vector<int> FractionVector::compare(const FractionVector &other) const {
+        checkSize(other);
+        // The vector kernels store whole aligned steps, so the result lives in aligned storage first
+        Storage result(size());
+        kernels().compare(numerators(), denominators(), other.numerators(), other.denominators(),
+                          result.data(), size());
+        return std::vector<int>(result.begin(), result.end());
+    }
+
+    FractionVector::SimdLevel FractionVector::simdLevel() {
+        return currentSimdLevel();
+    }
+
+    FractionVector::SimdLevel FractionVector::supportedSimdLevel() {
+        static const SimdLevel supported = detectSimdLevel();
+        return supported;
+    }
+
+    void FractionVector::setSimdLevel(SimdLevel level) {
+        if (level > supportedSimdLevel()) {
+            throw std::invalid_argument("Instruction set not supported by the processor");
+        }
+        currentSimdLevel() = level;
+    }
+}
@@ -0,0 +1,124 @@
+//
+// Structure of arrays container for int fractions with vectorized batch arithmetic.
+//
+
+#ifndef FRACTION_B_FRACTIONVECTOR_HPP
+#define FRACTION_B_FRACTIONVECTOR_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <vector>
+
+#include "Fraction.hpp"
+
+namespace ariel {
+    // Allocator returning storage aligned for the widest vector loads
+    template<typename T, std::size_t Alignment>
+    struct AlignedAllocator {
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() = default;
+
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+        T* allocate(std::size_t count) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+        }
+
+        void deallocate(T* pointer, std::size_t) {
+            ::operator delete(pointer, std::align_val_t{Alignment});
+        }
+
+        friend bool operator==(const AlignedAllocator&, const AlignedAllocator&) { return true; }
+    };
+
+    // A sequence of Fractions stored as two aligned arrays, one of numerators and one of denominators.
+    // The batch operations work element by element like the Fraction operators and throw the same
+    // exceptions, but process 8 elements per step with AVX2 (4 with SSE4, which only vectorizes the
+    // comparison). The instruction set is picked at runtime from what the processor supports, with a
+    // scalar fallback.
+    class FractionVector {
+    public:
+        // Instruction sets the batch operations can use
+        enum class SimdLevel { Scalar, Sse4, Avx2 };
+
+        // Alignment of both arrays, enough for AVX2 loads
+        static constexpr std::size_t ALIGNMENT = 32;
+
+        using Storage = std::vector<int, AlignedAllocator<int, ALIGNMENT>>;
+
+    private:
+        Storage numerator_values;   // Numerators of the fractions
+        Storage denominator_values; // Denominators of the fractions, always positive once reduced
+
+        // Throws invalid_argument if the other vector has a different size
+        void checkSize(const FractionVector& other) const;
+
+    public:
+        // Creates an empty vector
+        FractionVector();
+
+        // Creates a vector of size zeros (0/1)
+        explicit FractionVector(std::size_t size);
+
+        FractionVector(std::initializer_list<Fraction> fractions);
+
+        explicit FractionVector(const std::vector<Fraction>& fractions);
+
+        std::size_t size() const;
+        bool empty() const;
+        void reserve(std::size_t capacity);
+        void clear();
+
+        // Resizes the vector, new elements are zeros (0/1)
+        void resize(std::size_t size);
+
+        void push_back(const Fraction& fraction);
+
+        // Returns the element at the given index as a Fraction
+        Fraction operator[](std::size_t index) const;
+
+        // Stores a Fraction at the given index
+        void set(std::size_t index, const Fraction& fraction);
+
+        // Direct access to the arrays. After writing raw values through them call reduce().
+        int* numerators();
+        const int* numerators() const;
+        int* denominators();
+        const int* denominators() const;
+
+        // Reduces every element to its simplest form with a positive denominator.
+        // Throws invalid_argument for a zero denominator and overflow_error if a value can't be negated.
+        void reduce();
+
+        // Element wise arithmetic, both vectors must have the same size
+        // Throws overflow_error like the Fraction operators if a reduced result does not fit in an int
+        FractionVector add(const FractionVector& other) const;
+        FractionVector sub(const FractionVector& other) const;
+        FractionVector mul(const FractionVector& other) const;
+        // Throws runtime_error if an element of other is zero
+        FractionVector div(const FractionVector& other) const;
+
+        // Element wise exact comparison: -1, 0 or 1 as each element is less, equal or greater than other's
+        std::vector<int> compare(const FractionVector& other) const;
+
+        // The instruction set used by the batch operations, the best one supported by default
+        static SimdLevel simdLevel();
+
+        // The best instruction set supported by the processor
+        static SimdLevel supportedSimdLevel();
+
+        // Selects the instruction set used by the batch operations, mainly for tests and benchmarks.
+        // Throws invalid_argument if the processor does not support it.
+        static void setSimdLevel(SimdLevel level);
+    };
+}
+
+#endif //FRACTION_B_FRACTIONVECTOR_HPP
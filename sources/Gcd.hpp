@@ -0,0 +1,154 @@
+//
+// Greatest common divisor kernels used to keep fractions reduced.
+//
+
+#ifndef FRACTION_B_GCD_HPP
+#define FRACTION_B_GCD_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "FractionStats.hpp"
+
+namespace ariel {
+
+    // 128-bit integers are a compiler extension, both GCC and Clang provide them on 64-bit targets
+    using int128_t = __int128;
+    using uint128_t = unsigned __int128;
+
+    // Number of trailing zero bits of a non zero value
+    constexpr int countTrailingZeros(std::uint32_t value) {
+        return __builtin_ctz(value);
+    }
+
+    constexpr int countTrailingZeros(std::uint64_t value) {
+        return __builtin_ctzll(value);
+    }
+
+    constexpr int countTrailingZeros(uint128_t value) {
+        const unsigned half = 64;
+        auto low = static_cast<std::uint64_t>(value);
+        return low != 0 ? __builtin_ctzll(low) : static_cast<int>(half) + __builtin_ctzll(static_cast<std::uint64_t>(value >> half));
+    }
+
+    // Number of significant bits of a value, 0 for 0
+    constexpr int bitLength(uint128_t value) {
+        const unsigned half = 64;
+        auto high = static_cast<std::uint64_t>(value >> half);
+        if (high != 0) {
+            return static_cast<int>(2 * half) - __builtin_clzll(high);
+        }
+        auto low = static_cast<std::uint64_t>(value);
+        return low == 0 ? 0 : static_cast<int>(half) - __builtin_clzll(low);
+    }
+
+    // Euclid's algorithm, one division per step. Slowest on consecutive Fibonacci numbers.
+    template<typename UIntT>
+    constexpr UIntT euclidGcd(UIntT lhs, UIntT rhs) {
+        std::uint64_t iterations = 0;
+        while (rhs != 0) {
+            UIntT remainder = lhs % rhs;
+            lhs = rhs;
+            rhs = remainder;
+            iterations++;
+        }
+        detail::countStat(StatCounter::GcdIterations, iterations);
+        return lhs;
+    }
+
+    // Binary (Stein) gcd: strips common factors of two with a single count-trailing-zeros instruction
+    // and replaces divisions by subtractions and shifts
+    template<typename UIntT>
+    constexpr UIntT binaryGcd(UIntT lhs, UIntT rhs) {
+        if (lhs == 0) {
+            return rhs;
+        }
+        if (rhs == 0) {
+            return lhs;
+        }
+        int shift = countTrailingZeros(lhs | rhs);
+        lhs >>= countTrailingZeros(lhs);
+        std::uint64_t iterations = 0;
+        do {
+            // lhs is odd; min/max compile to conditional moves instead of an unpredictable branch
+            rhs >>= countTrailingZeros(rhs);
+            UIntT smaller = std::min(lhs, rhs);
+            rhs = std::max(lhs, rhs) - smaller;
+            lhs = smaller;
+            iterations++;
+        } while (rhs != 0);
+        detail::countStat(StatCounter::GcdIterations, iterations);
+        return lhs << shift;
+    }
+
+    // Number of leading bits Lehmer's algorithm simulates at a time, small enough that all cofactors
+    // and their sums fit in a signed 64-bit value
+    const int LEHMER_DIGIT_BITS = 60;
+
+    // Cofactors of a batch of Lehmer steps, the next pair is (a*x + b*y, c*x + d*y)
+    struct LehmerCofactors {
+        std::int64_t a;
+        std::int64_t b;
+        std::int64_t c;
+        std::int64_t d;
+    };
+
+    // Runs Euclid's algorithm on the leading digits x and y of two multi word values (Knuth, TAOCP 4.5.2
+    // algorithm L) for as long as the quotients are guaranteed to match those of the full values.
+    // b is 0 in the result if not even one step was certain.
+    constexpr LehmerCofactors lehmerCofactors(std::int64_t x, std::int64_t y) {
+        LehmerCofactors result{1, 0, 0, 1};
+        while (y + result.c != 0 && y + result.d != 0) {
+            std::int64_t quotient = (x + result.a) / (y + result.c);
+            if (quotient != (x + result.b) / (y + result.d)) {
+                break;
+            }
+            std::int64_t next = result.a - quotient * result.c;
+            result.a = result.c;
+            result.c = next;
+            next = result.b - quotient * result.d;
+            result.b = result.d;
+            result.d = next;
+            next = x - quotient * y;
+            x = y;
+            y = next;
+        }
+        return result;
+    }
+
+    // Lehmer's gcd for 128-bit values: most steps only look at the leading 60 bits and the full values
+    // are updated once per batch of steps. Finishes with the binary gcd once both values fit in 64 bits.
+    constexpr uint128_t lehmerGcd(uint128_t lhs, uint128_t rhs) {
+        if (lhs < rhs) {
+            std::swap(lhs, rhs);
+        }
+        const unsigned half = 64;
+        std::uint64_t iterations = 0;
+        while (rhs != 0 && (lhs >> half) != 0) {
+            auto shift = static_cast<unsigned>(bitLength(lhs) - LEHMER_DIGIT_BITS);
+            LehmerCofactors step = lehmerCofactors(static_cast<std::int64_t>(lhs >> shift),
+                                                   static_cast<std::int64_t>(rhs >> shift));
+            if (step.b == 0) {
+                uint128_t remainder = lhs % rhs;
+                lhs = rhs;
+                rhs = remainder;
+            } else {
+                // The true results are in [0, 2^128), so wrapping arithmetic computes them exactly
+                auto cofactor = [](std::int64_t value) { return static_cast<uint128_t>(static_cast<int128_t>(value)); };
+                uint128_t next_lhs = cofactor(step.a) * lhs + cofactor(step.b) * rhs;
+                uint128_t next_rhs = cofactor(step.c) * lhs + cofactor(step.d) * rhs;
+                lhs = next_lhs;
+                rhs = next_rhs;
+            }
+            iterations++;
+        }
+        detail::countStat(StatCounter::GcdIterations, iterations);
+        if (rhs == 0) {
+            return lhs;
+        }
+        return binaryGcd<std::uint64_t>(static_cast<std::uint64_t>(lhs), static_cast<std::uint64_t>(rhs));
+    }
+}
+
+#endif //FRACTION_B_GCD_HPP
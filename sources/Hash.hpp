@@ -0,0 +1,44 @@
+//
+// Hash functions over the reduced terms of a fraction.
+//
+
+#ifndef FRACTION_B_HASH_HPP
+#define FRACTION_B_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Gcd.hpp"
+
+namespace ariel::detail {
+    // Finalizer of MurmurHash3: every input bit affects every output bit, so the low bits can index a table
+    constexpr std::uint64_t mixBits(std::uint64_t value) {
+        const unsigned shift = 33;
+        value ^= value >> shift;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> shift;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> shift;
+        return value;
+    }
+
+    // Hash of a reduced numerator/denominator pair. Fractions are kept reduced, so equal fractions have
+    // equal terms and equal hashes. Terms up to 32 bits are packed into one 64-bit word and mixed once.
+    template<typename IntT>
+    constexpr std::size_t hashTerms(IntT numerator, IntT denominator) {
+        const unsigned half = 32;
+        if constexpr (sizeof(IntT) <= sizeof(std::uint32_t)) {
+            return mixBits(static_cast<std::uint64_t>(static_cast<std::uint32_t>(denominator)) << half |
+                           static_cast<std::uint32_t>(numerator));
+        } else {
+            // Wider terms are folded to 64 bits first
+            auto fold = [](IntT value) {
+                auto bits = static_cast<uint128_t>(value);
+                return static_cast<std::uint64_t>(bits) ^ mixBits(static_cast<std::uint64_t>(bits >> half >> half));
+            };
+            return mixBits(fold(numerator) ^ mixBits(fold(denominator)));
+        }
+    }
+}
+
+#endif //FRACTION_B_HASH_HPP
@@ -0,0 +1,164 @@
+//
+// Fractions that defer reduction until the value is observed.
+//
+
+#ifndef FRACTION_B_LAZYFRACTION_HPP
+#define FRACTION_B_LAZYFRACTION_HPP
+
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+#include "CheckedResult.hpp"
+#include "Fraction.hpp"
+#include "Hash.hpp"
+
+namespace ariel {
+    // A fraction for expression chains over Fraction values. The operators keep the numerator and
+    // denominator unreduced in 64-bit terms, which leaves 32 bits of headroom above int operands, and only
+    // run a gcd when a result no longer fits. Comparisons cross multiply in 128 bits and need no gcd;
+    // the getters, toFraction, hashing and printing reduce a copy. Intermediate values may leave the int
+    // range as long as they fit in 64 bits once reduced, so a chain can succeed where the same chain of
+    // Fraction operators would throw overflow_error.
+    class LazyFraction {
+    private:
+        std::int64_t numerator;   // Not necessarily reduced
+        std::int64_t denominator; // Not necessarily reduced, always positive
+
+        // Terms are kept symmetric around zero, so negating a term never overflows
+        static constexpr int128_t MAX_TERM = std::numeric_limits<std::int64_t>::max();
+
+        static constexpr bool fitsTerm(int128_t value) { return value >= -MAX_TERM && value <= MAX_TERM; }
+
+        constexpr LazyFraction(std::int64_t numerator, std::int64_t denominator, bool /*unchecked*/) :
+                numerator(numerator), denominator(denominator) {}
+
+        // Stores an exact 128-bit result, reducing it only if it does not fit as it is. The denominator
+        // must be positive. Throws overflow_error if even the reduced terms do not fit in 64 bits.
+        static constexpr LazyFraction fromWide(int128_t numerator, int128_t denominator) {
+            if (!fitsTerm(numerator) || !fitsTerm(denominator)) {
+                int128_t gcd = FractionTraits<int128_t>::gcd(numerator, denominator);
+                numerator /= gcd;
+                denominator /= gcd;
+                if (!fitsTerm(numerator) || !fitsTerm(denominator)) {
+                    throwFractionError(FractionError::Overflow);
+                }
+            }
+            return {static_cast<std::int64_t>(numerator), static_cast<std::int64_t>(denominator), true};
+        }
+
+        // The reduced value, the gcd runs here rather than in the operators
+        constexpr Fraction64 reduced() const { return *Fraction64::try_make(numerator, denominator); }
+
+    public:
+        // Creates 0/1
+        constexpr LazyFraction() : numerator(0), denominator(1) {}
+
+        // Throws invalid_argument if the denominator is zero
+        constexpr LazyFraction(int numerator, int denominator) : numerator(numerator), denominator(denominator) {
+            if (denominator == 0) {
+                throwFractionError(FractionError::ZeroDenominator);
+            }
+            if (denominator < 0) {
+                this->numerator = -this->numerator;
+                this->denominator = -this->denominator;
+            }
+        }
+
+        // Lossless conversion, implicit so that Fraction operands mix into the chains
+        constexpr LazyFraction(const Fraction& fraction) :
+                numerator(fraction.getNumerator()), denominator(fraction.getDenominator()) {}
+
+        // The reduced numerator
+        constexpr std::int64_t getNumerator() const { return reduced().getNumerator(); }
+
+        // The reduced denominator, always positive
+        constexpr std::int64_t getDenominator() const { return reduced().getDenominator(); }
+
+        // Reduces the stored terms
+        constexpr void simplify() {
+            Fraction64 value = reduced();
+            numerator = value.getNumerator();
+            denominator = value.getDenominator();
+        }
+
+        // The value as a Fraction, throws overflow_error if the reduced terms do not fit in an int
+        constexpr Fraction toFraction() const {
+            Fraction64 value = reduced();
+            std::int64_t new_numerator = value.getNumerator();
+            std::int64_t new_denominator = value.getDenominator();
+            if (!std::in_range<int>(new_numerator) || !std::in_range<int>(new_denominator)) {
+                throwFractionError(FractionError::Overflow);
+            }
+            return *Fraction::try_make(static_cast<int>(new_numerator), static_cast<int>(new_denominator));
+        }
+
+        // Arithmetic operators, exact in 128 bits before the result is stored. They are hidden friends, so a
+        // Fraction converts on either side.
+        friend constexpr LazyFraction operator+(const LazyFraction& lhs, const LazyFraction& rhs) {
+            return fromWide(int128_t{lhs.numerator} * rhs.denominator + int128_t{rhs.numerator} * lhs.denominator,
+                            int128_t{lhs.denominator} * rhs.denominator);
+        }
+
+        friend constexpr LazyFraction operator-(const LazyFraction& lhs, const LazyFraction& rhs) {
+            return fromWide(int128_t{lhs.numerator} * rhs.denominator - int128_t{rhs.numerator} * lhs.denominator,
+                            int128_t{lhs.denominator} * rhs.denominator);
+        }
+
+        friend constexpr LazyFraction operator*(const LazyFraction& lhs, const LazyFraction& rhs) {
+            return fromWide(int128_t{lhs.numerator} * rhs.numerator, int128_t{lhs.denominator} * rhs.denominator);
+        }
+
+        // Throws runtime_error if dividing by zero
+        friend constexpr LazyFraction operator/(const LazyFraction& lhs, const LazyFraction& rhs) {
+            if (rhs.numerator == 0) {
+                throwFractionError(FractionError::DivisionByZero);
+            }
+            int128_t new_numerator = int128_t{lhs.numerator} * rhs.denominator;
+            int128_t new_denominator = int128_t{lhs.denominator} * rhs.numerator;
+            if (new_denominator < 0) {
+                new_numerator = -new_numerator;
+                new_denominator = -new_denominator;
+            }
+            return fromWide(new_numerator, new_denominator);
+        }
+
+        constexpr LazyFraction& operator+=(const LazyFraction& other) { return *this = *this + other; }
+
+        constexpr LazyFraction& operator-=(const LazyFraction& other) { return *this = *this - other; }
+
+        constexpr LazyFraction& operator*=(const LazyFraction& other) { return *this = *this * other; }
+
+        constexpr LazyFraction& operator/=(const LazyFraction& other) { return *this = *this / other; }
+
+        // Both cross products fit in 128 bits, so unreduced values compare exactly
+        friend constexpr std::strong_ordering operator<=>(const LazyFraction& lhs, const LazyFraction& rhs) {
+            return int128_t{lhs.numerator} * rhs.denominator <=> int128_t{rhs.numerator} * lhs.denominator;
+        }
+
+        friend constexpr bool operator==(const LazyFraction& lhs, const LazyFraction& rhs) {
+            return int128_t{lhs.numerator} * rhs.denominator == int128_t{rhs.numerator} * lhs.denominator;
+        }
+
+        // Prints the reduced value in the format numerator/denominator
+        friend std::ostream& operator<<(std::ostream& stream, const LazyFraction& value) {
+            return stream << value.reduced();
+        }
+
+        friend struct std::hash<LazyFraction>;
+    };
+}
+
+// Hashes the reduced terms, so equal values hash alike however they are stored
+template<>
+struct std::hash<ariel::LazyFraction> {
+    std::size_t operator()(const ariel::LazyFraction& value) const noexcept {
+        ariel::Fraction64 reduced = value.reduced();
+        return ariel::detail::hashTerms(reduced.getNumerator(), reduced.getDenominator());
+    }
+};
+
+#endif //FRACTION_B_LAZYFRACTION_HPP
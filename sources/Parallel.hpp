@@ -0,0 +1,43 @@
+//
+// Helpers for splitting work on fraction arrays across threads.
+//
+
+#ifndef FRACTION_B_PARALLEL_HPP
+#define FRACTION_B_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace ariel::detail {
+    // Below this many elements starting the threads costs more than they save
+    const std::size_t PARALLEL_THRESHOLD = std::size_t{1} << 16;
+
+    // Number of workers for a requested thread count, 0 for one per hardware thread
+    inline unsigned workerCount(unsigned threads, unsigned max_workers) {
+        unsigned workers = threads != 0 ? threads : std::thread::hardware_concurrency();
+        return std::clamp(workers, 1U, max_workers);
+    }
+
+    // First index of chunk number chunk when size elements are split into chunks nearly equal parts
+    constexpr std::size_t chunkBegin(std::size_t size, unsigned chunks, unsigned chunk) {
+        return size / chunks * chunk + std::min<std::size_t>(size % chunks, chunk);
+    }
+
+    // Calls work(0) to work(workers - 1) on as many threads, the calling thread runs work(0)
+    template<typename Work>
+    void runParallel(unsigned workers, Work work) {
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (unsigned worker = 1; worker < workers; worker++) {
+            threads.emplace_back(work, worker);
+        }
+        work(0);
+        for (std::thread &thread: threads) {
+            thread.join();
+        }
+    }
+}
+
+#endif //FRACTION_B_PARALLEL_HPP
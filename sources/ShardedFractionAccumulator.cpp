@@ -0,0 +1,57 @@
+//
+// A running sum of fractions that many threads add to without contending.
+//
+#include "ShardedFractionAccumulator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "WideSum.hpp"
+
+namespace ariel {
+
+    namespace {
+        // Shards are aligned to whole cache lines, so that two threads never write to the same line
+        const std::size_t CACHE_LINE = 64;
+
+        // Threads are numbered in the order they first add, the number picks their shard
+        std::atomic<unsigned> next_thread{0};
+        thread_local const unsigned thread_number = next_thread.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    struct alignas(CACHE_LINE) ShardedFractionAccumulator::Shard {
+        mutable std::mutex lock;
+        detail::WideSum sum;
+    };
+
+    ShardedFractionAccumulator::ShardedFractionAccumulator(unsigned shards) :
+            shard_count(shards != 0 ? shards : std::max(std::thread::hardware_concurrency(), 1U)),
+            shards(std::make_unique<Shard[]>(shard_count)) {}
+
+    ShardedFractionAccumulator::~ShardedFractionAccumulator() = default;
+
+    void ShardedFractionAccumulator::add(const Fraction &value) {
+        Shard &shard = shards[thread_number % shard_count];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        shard.sum.add(value.getNumerator(), static_cast<std::uint64_t>(value.getDenominator()));
+    }
+
+    BigFraction ShardedFractionAccumulator::snapshot() const {
+        BigFraction total;
+        for (unsigned i = 0; i < shard_count; i++) {
+            std::lock_guard<std::mutex> guard(shards[i].lock);
+            total += shards[i].sum.result();
+        }
+        return total;
+    }
+
+    void ShardedFractionAccumulator::reset() {
+        for (unsigned i = 0; i < shard_count; i++) {
+            std::lock_guard<std::mutex> guard(shards[i].lock);
+            shards[i].sum = detail::WideSum();
+        }
+    }
+}
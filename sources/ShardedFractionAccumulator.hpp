@@ -0,0 +1,50 @@
+//
+// A running sum of fractions that many threads add to without contending.
+//
+
+#ifndef FRACTION_B_SHARDEDFRACTIONACCUMULATOR_HPP
+#define FRACTION_B_SHARDEDFRACTIONACCUMULATOR_HPP
+
+#include <memory>
+
+#include "BigFraction.hpp"
+#include "Fraction.hpp"
+
+namespace ariel {
+    // An exact running sum split into shards, each on its own cache lines. A thread always adds into the same
+    // shard, chosen when it first adds to any accumulator, so threads only share a shard when there are
+    // more threads than shards. Each shard keeps an unreduced 128-bit sum like ariel::sum and is guarded by
+    // its own lock, which only the readers of snapshot() and reset() ever contend for. The sum never
+    // overflows.
+    class ShardedFractionAccumulator {
+    private:
+        struct Shard;
+
+        unsigned shard_count;
+        std::unique_ptr<Shard[]> shards;
+
+    public:
+        // Creates an empty sum with the given number of shards, 0 for one per hardware thread
+        explicit ShardedFractionAccumulator(unsigned shards = 0);
+
+        ~ShardedFractionAccumulator();
+
+        ShardedFractionAccumulator(const ShardedFractionAccumulator&) = delete;
+
+        ShardedFractionAccumulator& operator=(const ShardedFractionAccumulator&) = delete;
+
+        unsigned shardCount() const { return shard_count; }
+
+        // Adds value to the shard of the calling thread
+        void add(const Fraction& value);
+
+        // The exact sum of all shards. Includes every add that finished before the call; adds running
+        // concurrently may or may not be included.
+        BigFraction snapshot() const;
+
+        // Empties every shard. Adds running concurrently may or may not be kept.
+        void reset();
+    };
+}
+
+#endif //FRACTION_B_SHARDEDFRACTIONACCUMULATOR_HPP
@@ -0,0 +1,122 @@
+//
+// Exact running sum of fractions over a 128-bit common denominator.
+//
+
+#ifndef FRACTION_B_WIDESUM_HPP
+#define FRACTION_B_WIDESUM_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "BigFraction.hpp"
+#include "Gcd.hpp"
+
+namespace ariel::detail {
+    // A running sum of fractions kept as an unreduced numerator over the lcm of the denominators added
+    // so far. Once most denominators have been seen, adding a term is one multiplication and one
+    // addition. Whatever no longer fits in 128 bits is spilled into a BigFraction.
+    class WideSum {
+    private:
+        // Small denominators remember their scale factor until the common denominator changes
+        static constexpr std::uint64_t CACHED_DENOMINATORS = 64;
+
+        // A product of values below 2^a and 2^b in magnitude is below 2^(a + b)
+        static constexpr int MAX_PRODUCT_BITS = 127;
+
+        struct Scale {
+            int128_t factor; // denominator / d
+            int bits;        // Bit length of factor
+            std::uint64_t generation;
+        };
+
+        int128_t numerator = 0;
+        int128_t denominator = 1; // Always positive
+        BigFraction spilled;
+        std::uint64_t generation = 1; // Bumped whenever the denominator changes
+        std::array<Scale, CACHED_DENOMINATORS> cached_scales{};
+
+        void setDenominator(int128_t new_denominator) {
+            denominator = new_denominator;
+            generation++;
+        }
+
+        // Adds term_numerator * scale.factor if the result fits, returns false and leaves the sum unchanged
+        // otherwise. The bit lengths rule out overflow for most terms much faster than the checked 128-bit
+        // multiplication; the magnitude is computed without a branch on the sign, which is random.
+        bool addScaled(std::int64_t term_numerator, const Scale& scale) {
+            const unsigned sign_shift = 63;
+            auto sign = static_cast<std::uint64_t>(term_numerator >> sign_shift);
+            std::uint64_t magnitude = (static_cast<std::uint64_t>(term_numerator) ^ sign) - sign;
+            int128_t scaled_term;
+            if (static_cast<int>(std::bit_width(magnitude)) + scale.bits <= MAX_PRODUCT_BITS) {
+                scaled_term = term_numerator * scale.factor;
+            } else if (__builtin_mul_overflow(static_cast<int128_t>(term_numerator), scale.factor, &scaled_term)) {
+                return false;
+            }
+            int128_t new_numerator;
+            if (__builtin_add_overflow(numerator, scaled_term, &new_numerator)) {
+                return false;
+            }
+            numerator = new_numerator;
+            return true;
+        }
+
+        // Adds the term when its scale factor is not cached, spilling the sum if the result does not fit.
+        // Kept out of line so that add() stays small enough to inline into the loops.
+        __attribute__((noinline)) void addUncached(std::int64_t term_numerator, std::uint64_t term_denominator) {
+            auto remainder = static_cast<std::uint64_t>(static_cast<uint128_t>(denominator) % term_denominator);
+            if (remainder == 0) {
+                // The term denominator already divides the common denominator
+                auto factor = static_cast<int128_t>(static_cast<uint128_t>(denominator) / term_denominator);
+                Scale scale{factor, bitLength(static_cast<uint128_t>(factor)), generation};
+                if (term_denominator < CACHED_DENOMINATORS) {
+                    cached_scales[term_denominator] = scale;
+                }
+                if (!addScaled(term_numerator, scale)) {
+                    spill(term_numerator, term_denominator);
+                }
+                return;
+            }
+            std::uint64_t gcd = binaryGcd(term_denominator, remainder);
+            auto self_scale = static_cast<int128_t>(term_denominator / gcd);
+            auto term_scale = static_cast<int128_t>(static_cast<uint128_t>(denominator) / gcd);
+            int128_t scaled_self;
+            int128_t scaled_term;
+            int128_t new_numerator;
+            int128_t new_denominator;
+            if (__builtin_mul_overflow(denominator, self_scale, &new_denominator) ||
+                __builtin_mul_overflow(numerator, self_scale, &scaled_self) ||
+                __builtin_mul_overflow(static_cast<int128_t>(term_numerator), term_scale, &scaled_term) ||
+                __builtin_add_overflow(scaled_self, scaled_term, &new_numerator)) {
+                spill(term_numerator, term_denominator);
+                return;
+            }
+            numerator = new_numerator;
+            setDenominator(new_denominator);
+        }
+
+        // Moves the pending sum into the BigFraction and restarts from the term
+        void spill(std::int64_t term_numerator, std::uint64_t term_denominator) {
+            spilled += BigFraction(BigInteger(numerator), BigInteger(denominator));
+            numerator = term_numerator;
+            setDenominator(static_cast<int128_t>(term_denominator));
+        }
+
+    public:
+        // Adds term_numerator / term_denominator, the denominator must be positive and below 2^63
+        void add(std::int64_t term_numerator, std::uint64_t term_denominator) {
+            if (term_denominator >= CACHED_DENOMINATORS ||
+                cached_scales[term_denominator].generation != generation ||
+                !addScaled(term_numerator, cached_scales[term_denominator])) {
+                addUncached(term_numerator, term_denominator);
+            }
+        }
+
+        BigFraction result() const {
+            return spilled + BigFraction(BigInteger(numerator), BigInteger(denominator));
+        }
+    };
+}
+
+#endif //FRACTION_B_WIDESUM_HPP